@@ -0,0 +1,1615 @@
+#include "MutexString.hpp"
+#include "InlineMutexString.hpp"
+#include "SeqlockString.hpp"
+#include "SnapshotString.hpp"
+#include "StringSearch.hpp"
+#include "LogBuffer.hpp"
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <cstdint>
+#include <functional>
+#include <algorithm>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <cstddef>
+#include <cstdlib>
+#include <random>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <cerrno>
+#include <utility>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// micro benchmarks for j2::BasicMutexString variants
+// - build type Release is recommended (cmake -DCMAKE_BUILD_TYPE=Release)
+// - numbers depend heavily on core count; run on the target machine
+// - the search kernels are first checked against the standard library on random inputs;
+//   a mismatch prints the case and aborts before anything is timed (--check runs only the checks)
+
+using namespace std::chrono_literals;
+using bench_clock = std::chrono::steady_clock;
+
+void benchSharedReads();
+void benchSeqlockReads();
+void benchSnapshotStr();
+void benchAdaptiveLatency();
+void benchFootprint();
+void benchSizeMirror();
+void benchCombiningAppend();
+void benchShardedAppend();
+void benchCowSnapshot();
+void benchSubstrViews();
+void benchPmrArena();
+void benchInlineAssign();
+void benchFalseSharing();
+void benchFind();
+void benchFindOf();
+void benchPatternSet();
+void benchParallelFind();
+void benchSearcher();
+
+void checkSearchKernels();
+void checkFindOf();
+void checkPatternSet();
+void checkParallelFind();
+void checkSearcher();
+void checkInterned();
+void checkSnapshotString();
+void checkListeners();
+void checkVersionWaits();
+void checkLogBuffer();
+void checkTryLock();
+void checkMemoryStats();
+
+int main(int argc, char** argv) {
+
+    // find()/rfind() kernels at every level up to simd_level() vs std::string_view
+    checkSearchKernels();
+
+    // find_first_of()/find_last_of() (and _not_of) kernels at every level vs std::string_view
+    checkFindOf();
+
+    // PatternSet find_any()/find_all()/count() vs comparing every pattern at every end position
+    checkPatternSet();
+
+    // parallel_find()/parallel_count() with tiny chunks (matches across chunk borders) vs std::string_view
+    checkParallelFind();
+
+    // find_pair() kernels at every level with arbitrary filter offsets, and Searcher find()/count(), vs std::string_view
+    checkSearcher();
+
+    // assign(Interned): shared pool entry, copy on first write, Snapshots that outlive the pool
+    checkInterned();
+
+    // SnapshotString: readers racing writers see whole published values, held Snapshots never change,
+    // update() callbacks may read the object (build with SNAPSHOT_STRING_LOCKED for the lock-based path)
+    checkSnapshotString();
+
+    // subscribe(): merged events of a slow listener, snapshot payloads, unsubscribe from inside,
+    // a Subscription outliving its object, an executor that throws
+    checkListeners();
+
+    // version(), wait_for_change(), wait_until(), wait_for(): wake-ups, timeouts, "forever" timeouts
+    checkVersionWaits();
+
+    // LogBuffer: drain()/recycle() round trip, background flusher into a pipe, failed writes
+    checkLogBuffer();
+
+    // try_with()/try_guard()/with_for()/with_until(): free lock, busy lock, shared readers
+    checkTryLock();
+
+    // memory_usage()/memory_totals() against std::string doing the same appends (jstr with MUTEX_STRING_MEMORY_STATS)
+    checkMemoryStats();
+
+    // --check: stop here (sanitizer builds, CI)
+    if (argc > 1 && std::string_view(argv[1]) == "--check") return 0;
+
+    // const members under std::mutex vs std::shared_mutex, 1..N reader threads
+    benchSharedReads();
+
+    // short reads: shared lock vs seqlock optimistic reads
+    benchSeqlockReads();
+
+    // str() of a 4 KiB value: copy under the lock vs RCU snapshot
+    benchSnapshotStr();
+
+    // append/compare latency percentiles: std::mutex vs SpinLock vs AdaptiveLock
+    benchAdaptiveLatency();
+
+    // per-object size and memory of 1M session structs, plus uncontended append cost
+    benchFootprint();
+
+    // size()/empty() polling while writers append: lock vs atomic mirror
+    benchSizeMirror();
+
+    // append scaling 1..64 threads: lock per call vs flat combining
+    benchCombiningAppend();
+
+    // trace accumulator: append-mostly, one reader drains every 1ms
+    benchShardedAppend();
+
+    // 64 KiB value: str() copy under the lock vs copy-on-write snapshot(), with one writer
+    benchCowSnapshot();
+
+    // parsing a message: substr() per field vs views() + zero-copy slices
+    benchSubstrViews();
+
+    // build-then-read request strings: global heap vs per-request monotonic arena
+    benchPmrArena();
+
+    // 20-60 char values (hostnames, tenant IDs): std::string SSO vs in-object InlineMutexString<64>
+    benchInlineAssign();
+
+    // every thread appends to its own element of one vector: packed vs cache-line aligned objects
+    benchFalseSharing();
+
+    // find()/rfind() scan speed across haystack/needle sizes: standard library vs SSE2/AVX2/AVX-512 kernels
+    benchFind();
+
+    // find_first_of()/find_first_not_of() with 1-16 char sets: standard library vs table/shuffle kernels
+    benchFindOf();
+
+    // any of 1-500 keywords: find() per keyword vs one Aho-Corasick pass with find_any(PatternSet)
+    benchPatternSet();
+
+    // 64 MiB value: find() under the lock vs parallel_find() on a pinned snapshot, 1-8 threads
+    benchParallelFind();
+
+    // repeated find() of one needle in URL text: analyzed per call vs a precompiled Searcher
+    benchSearcher();
+
+    return 0;
+}
+
+//---------------------------------------------------------------------------
+// helpers
+
+// thread counts 1, 2, 4, ... up to (at least) hardware_concurrency
+static std::vector<unsigned> threadCounts(unsigned max_threads = 0) {
+    unsigned hw = std::thread::hardware_concurrency();
+    if (max_threads == 0) max_threads = hw ? hw : 4;
+    std::vector<unsigned> v;
+    for (unsigned n = 1; n < max_threads; n *= 2) v.push_back(n);
+    v.push_back(max_threads);
+    return v;
+}
+
+// run body(thread_index) in a loop on n threads for `duration`, return total iterations
+static std::uint64_t runThreads(unsigned n, std::chrono::milliseconds duration,
+                                const std::function<void(unsigned)>& body) {
+    std::atomic<bool> go{false}, stop{false};
+    std::atomic<std::uint64_t> total{0};
+    std::vector<std::thread> ts;
+    for (unsigned t = 0; t < n; ++t) {
+        ts.emplace_back([&, t]{
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            std::uint64_t ops = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                body(t);
+                ++ops;
+            }
+            total += ops;
+        });
+    }
+    go.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(duration);
+    stop.store(true);
+    for (auto& th : ts) th.join();
+    return total.load();
+}
+
+static double mops(std::uint64_t ops, std::chrono::milliseconds d) {
+    return static_cast<double>(ops) / (static_cast<double>(d.count()) * 1000.0);
+}
+
+// differential checks: fixed seed, so a failure reproduces on the next run
+static std::mt19937& checkRng() {
+    static std::mt19937 rng(20240611);
+    return rng;
+}
+
+// n bytes drawn from the first `letters` chars of alphabet (few letters: many partial matches)
+static std::string randomText(std::size_t n, std::string_view alphabet, std::size_t letters) {
+    std::string s(n, '\0');
+    for (char& c : s) c = alphabet[checkRng()() % std::max<std::size_t>(1, std::min(letters, alphabet.size()))];
+    return s;
+}
+
+static void expectSame(std::size_t got, std::size_t expected, const std::string& what,
+                       std::string_view text, std::string_view needle, std::size_t pos) {
+    if (got == expected) return;
+    std::cerr << "\nMISMATCH " << what << ": got " << static_cast<std::ptrdiff_t>(got)
+              << ", expected " << static_cast<std::ptrdiff_t>(expected) << " (text " << text.size() << " bytes, needle "
+              << needle.size() << " bytes, pos " << static_cast<std::ptrdiff_t>(pos) << ")\n"
+              << "  text:   \"" << text << "\"\n  needle: \"" << needle << "\"\n";
+    std::abort();
+}
+
+static void expectTrue(bool ok, const std::string& what) {
+    if (ok) return;
+    std::cerr << "\nCHECK FAILED: " << what << "\n";
+    std::abort();
+}
+
+// polls cond until it holds; false after `limit` (a listener that never runs, a deadlock)
+static bool eventually(const std::function<bool()>& cond, std::chrono::milliseconds limit = 10s) {
+    for (const auto end = bench_clock::now() + limit; !cond();) {
+        if (bench_clock::now() > end) return false;
+        std::this_thread::sleep_for(1ms);
+    }
+    return true;
+}
+
+// every level this CPU runs (search_kernels() of a higher one would silently test a lower one twice)
+static std::vector<j2::SimdLevel> supportedLevels() {
+    std::vector<j2::SimdLevel> v;
+    for (j2::SimdLevel l : {j2::SimdLevel::scalar, j2::SimdLevel::sse2, j2::SimdLevel::avx2, j2::SimdLevel::avx512}) {
+        if (l <= j2::simd_level()) v.push_back(l);
+    }
+    return v;
+}
+
+//---------------------------------------------------------------------------
+// read scaling: every thread runs size()/find()/operator== on one shared string,
+// one extra writer thread assigns every 1ms (read-mostly workload)
+template <typename S>
+static double readScaling(unsigned readers, std::chrono::milliseconds d) {
+    S ms = "tenant=acme;region=eu-west-1;status=active";
+    std::atomic<bool> stop{false};
+    std::thread writer([&]{
+        while (!stop.load()) {
+            ms = "tenant=acme;region=eu-west-1;status=active";
+            std::this_thread::sleep_for(1ms);
+        }
+    });
+    std::uint64_t ops = runThreads(readers, d, [&](unsigned){
+        volatile std::size_t sink = ms.size() + ms.find("status");
+        volatile bool eq = (ms == "status=active");
+        (void)sink; (void)eq;
+    });
+    stop.store(true);
+    writer.join();
+    return mops(ops, d);
+}
+
+void benchSharedReads() {
+    std::cout << "\n===== benchSharedReads: Mops/s (size+find+==), 1 writer @1kHz =====\n";
+    std::cout << std::setw(8) << "threads" << std::setw(14) << "std::mutex" << std::setw(16) << "shared_mutex" << "\n";
+    constexpr auto d = 300ms;
+    for (unsigned n : threadCounts()) {
+        std::cout << std::setw(8) << n
+                  << std::setw(14) << std::fixed << std::setprecision(2) << readScaling<j2::MutexString>(n, d)
+                  << std::setw(16) << readScaling<j2::SharedMutexString>(n, d) << "\n";
+    }
+}
+
+//---------------------------------------------------------------------------
+// short reads only (size + front + ==): the shared lock still writes its counter line,
+// seqlock readers only load
+template <typename S>
+static double shortReads(unsigned readers, std::chrono::milliseconds d) {
+    S ms = "status=active";
+    std::atomic<bool> stop{false};
+    std::thread writer([&]{
+        bool flip = false;
+        while (!stop.load()) {
+            ms = (flip = !flip) ? "status=active" : "status=draining";
+            std::this_thread::sleep_for(1ms);
+        }
+    });
+    std::uint64_t ops = runThreads(readers, d, [&](unsigned){
+        volatile std::size_t sink = ms.size();
+        volatile char f = ms.front();
+        volatile bool eq = (ms == "status=active");
+        (void)sink; (void)f; (void)eq;
+    });
+    stop.store(true);
+    writer.join();
+    return mops(ops, d);
+}
+
+void benchSeqlockReads() {
+    std::cout << "\n===== benchSeqlockReads: Mops/s (size+front+==), 1 writer @1kHz =====\n";
+    std::cout << std::setw(8) << "threads" << std::setw(16) << "shared_mutex" << std::setw(16) << "SeqlockString" << "\n";
+    constexpr auto d = 300ms;
+    for (unsigned n : threadCounts()) {
+        std::cout << std::setw(8) << n
+                  << std::setw(16) << std::fixed << std::setprecision(2) << shortReads<j2::SharedMutexString>(n, d)
+                  << std::setw(16) << shortReads<j2::SeqlockString<64>>(n, d) << "\n";
+    }
+}
+
+//---------------------------------------------------------------------------
+// str() of a 4 KiB config blob on N reader threads
+template <typename S>
+static double strReads(unsigned readers, std::chrono::milliseconds d) {
+    S ms = std::string(4096, 'c');
+    std::uint64_t ops = runThreads(readers, d, [&](unsigned){
+        auto snap = ms.str();
+        volatile std::size_t sink = snap.size();
+        (void)sink;
+    });
+    return mops(ops, d);
+}
+
+void benchSnapshotStr() {
+    std::cout << "\n===== benchSnapshotStr: Mops/s of str() on a 4 KiB value =====\n";
+    std::cout << std::setw(8) << "threads" << std::setw(14) << "MutexString" << std::setw(16) << "SnapshotString" << "\n";
+    constexpr auto d = 300ms;
+    for (unsigned n : threadCounts()) {
+        std::cout << std::setw(8) << n
+                  << std::setw(14) << std::fixed << std::setprecision(2) << strReads<j2::MutexString>(n, d)
+                  << std::setw(16) << strReads<j2::SnapshotString>(n, d) << "\n";
+    }
+}
+
+//---------------------------------------------------------------------------
+// per-operation latency of a contended append/compare mix
+// - every thread alternates append("x") and operator==, clearing the buffer every 4096 calls
+// - each call is timed individually; p50/p99 are taken over all threads
+struct Percentiles { double p50_ns, p99_ns; };
+
+template <typename S>
+static Percentiles appendCompareLatency(unsigned threads, std::size_t ops_per_thread) {
+    S ms;
+    std::vector<std::vector<std::uint32_t>> samples(threads);
+    std::atomic<unsigned> ready{0};
+    std::vector<std::thread> ts;
+    for (unsigned t = 0; t < threads; ++t) {
+        ts.emplace_back([&, t]{
+            auto& out = samples[t];
+            out.reserve(ops_per_thread);
+            ++ready;
+            while (ready.load() < threads) std::this_thread::yield();
+            for (std::size_t i = 0; i < ops_per_thread; ++i) {
+                auto a = bench_clock::now();
+                if (i & 1) {
+                    volatile bool eq = (ms == "request-log-line");
+                    (void)eq;
+                } else if ((i & 4095) == 0) {
+                    ms.clear();
+                } else {
+                    ms.append("x");
+                }
+                auto b = bench_clock::now();
+                out.push_back(static_cast<std::uint32_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count()));
+            }
+        });
+    }
+    for (auto& th : ts) th.join();
+
+    std::vector<std::uint32_t> all;
+    for (auto& v : samples) all.insert(all.end(), v.begin(), v.end());
+    auto pct = [&](double p) {
+        std::size_t k = static_cast<std::size_t>(p * static_cast<double>(all.size() - 1));
+        std::nth_element(all.begin(), all.begin() + static_cast<std::ptrdiff_t>(k), all.end());
+        return static_cast<double>(all[k]);
+    };
+    double p50 = pct(0.50);
+    double p99 = pct(0.99);
+    return {p50, p99};
+}
+
+void benchAdaptiveLatency() {
+    std::cout << "\n===== benchAdaptiveLatency: append/compare, ns per call (p50 / p99) =====\n";
+    std::cout << std::setw(8) << "threads"
+              << std::setw(22) << "std::mutex"
+              << std::setw(22) << "SpinLock"
+              << std::setw(22) << "AdaptiveLock" << "\n";
+    constexpr std::size_t ops = 200000;
+    auto cell = [](const Percentiles& p) {
+        return std::to_string(static_cast<long>(p.p50_ns)) + " / " + std::to_string(static_cast<long>(p.p99_ns));
+    };
+    for (unsigned n : threadCounts(std::max(4u, std::thread::hardware_concurrency()))) {
+        std::cout << std::setw(8) << n
+                  << std::setw(22) << cell(appendCompareLatency<j2::MutexString>(n, ops))
+                  << std::setw(22) << cell(appendCompareLatency<j2::SpinMutexString>(n, ops))
+                  << std::setw(22) << cell(appendCompareLatency<j2::AdaptiveMutexString>(n, ops)) << "\n";
+    }
+}
+
+//---------------------------------------------------------------------------
+// memory footprint: a per-session struct with four string fields, one million sessions
+// (short values stay in the SSO buffer, so the object size is the whole cost)
+template <typename S>
+struct Session {
+    S user, tenant, region, status;
+};
+
+template <typename S>
+static void footprintRow(const char* name) {
+    constexpr std::size_t sessions = 1000000;
+    auto t0 = bench_clock::now();
+    std::vector<Session<S>> v(sessions);
+    for (auto& s : v) { s.user = "u-1234"; s.status = "active"; }
+    auto init = std::chrono::duration_cast<std::chrono::milliseconds>(bench_clock::now() - t0);
+
+    // uncontended append + clear on one object: the lock's fast path only
+    S one;
+    constexpr std::size_t ops = 2000000;
+    auto t1 = bench_clock::now();
+    for (std::size_t i = 0; i < ops; ++i) {
+        if ((i & 15) == 0) one.clear();
+        one.append("x");
+    }
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - t1).count();
+
+    std::cout << std::setw(22) << name
+              << std::setw(10) << sizeof(S)
+              << std::setw(14) << std::fixed << std::setprecision(1)
+              << static_cast<double>(sizeof(Session<S>) * sessions) / (1024.0 * 1024.0)
+              << std::setw(12) << init.count()
+              << std::setw(14) << std::setprecision(2) << static_cast<double>(ns) / ops << "\n";
+}
+
+void benchFootprint() {
+    std::cout << "\n===== benchFootprint: 1M sessions x 4 fields =====\n";
+    std::cout << std::setw(22) << "type" << std::setw(10) << "sizeof" << std::setw(14) << "MiB"
+              << std::setw(12) << "init ms" << std::setw(14) << "append ns" << "\n";
+    footprintRow<std::string>("std::string");
+    footprintRow<j2::MutexString>("MutexString");
+    footprintRow<j2::BasicMutexString<std::mutex, j2::feature::none>>("MutexString (none)");
+    footprintRow<j2::SharedMutexString>("SharedMutexString");
+    footprintRow<j2::AdaptiveMutexString>("AdaptiveMutexString");
+    footprintRow<j2::CompactMutexString>("CompactMutexString");
+}
+
+//---------------------------------------------------------------------------
+// monitoring pattern: N threads poll size()/empty(), 2 writer threads append (and clear past 64 KiB)
+struct PollResult { double poll_mops, write_mops; };
+
+template <typename S>
+static PollResult pollWhileAppending(unsigned pollers, std::chrono::milliseconds d) {
+    S ms;
+    std::atomic<bool> stop{false};
+    std::atomic<std::uint64_t> writes{0};
+    std::vector<std::thread> writers;
+    for (int w = 0; w < 2; ++w) {
+        writers.emplace_back([&]{
+            std::uint64_t n = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                ms.append("log line\n");
+                if ((++n & 8191) == 0) ms.clear();
+            }
+            writes += n;
+        });
+    }
+    std::uint64_t polls = runThreads(pollers, d, [&](unsigned){
+        volatile std::size_t n = ms.size();
+        volatile bool e = ms.empty();
+        (void)n; (void)e;
+    });
+    stop.store(true);
+    for (auto& th : writers) th.join();
+    return {mops(polls, d), mops(writes.load(), d)};
+}
+
+void benchSizeMirror() {
+    std::cout << "\n===== benchSizeMirror: Mops/s of size()+empty() pollers / appends, 2 writers =====\n";
+    std::cout << std::setw(8) << "threads" << std::setw(24) << "locked (poll/append)"
+              << std::setw(24) << "mirror (poll/append)" << "\n";
+    constexpr auto d = 300ms;
+    for (unsigned n : threadCounts()) {
+        auto locked = pollWhileAppending<j2::BasicMutexString<std::mutex, j2::feature::none>>(n, d);
+        auto mirror = pollWhileAppending<j2::MutexString>(n, d);
+        std::cout << std::setw(8) << n << std::fixed << std::setprecision(2)
+                  << std::setw(12) << locked.poll_mops << std::setw(12) << locked.write_mops
+                  << std::setw(12) << mirror.poll_mops << std::setw(12) << mirror.write_mops << "\n";
+    }
+}
+
+//---------------------------------------------------------------------------
+// shared request-log buffer: every thread appends one line per iteration,
+// the buffer is cleared once it passes 1 MiB (size() is a lock-free mirror load)
+template <typename S>
+static double appendScaling(unsigned threads, std::chrono::milliseconds d) {
+    S log;
+    std::uint64_t ops = runThreads(threads, d, [&](unsigned){
+        log += "GET /api/v1/items 200 12ms\n";
+        if (log.size() > (1u << 20)) log.clear();
+    });
+    return mops(ops, d);
+}
+
+void benchCombiningAppend() {
+    std::cout << "\n===== benchCombiningAppend: Mops/s of operator+= on one shared buffer =====\n";
+    std::cout << std::setw(8) << "threads" << std::setw(14) << "MutexString"
+              << std::setw(22) << "CombiningMutexString" << "\n";
+    constexpr auto d = 300ms;
+    for (unsigned n : threadCounts(64)) {
+        std::cout << std::setw(8) << n
+                  << std::setw(14) << std::fixed << std::setprecision(2) << appendScaling<j2::MutexString>(n, d)
+                  << std::setw(22) << appendScaling<j2::CombiningMutexString>(n, d) << "\n";
+    }
+}
+
+//---------------------------------------------------------------------------
+// append-mostly accumulator: N threads append short spans, one collector takes str() + clear() every 1ms
+template <typename S>
+static double accumulate(unsigned threads, std::chrono::milliseconds d) {
+    S trace;
+    std::atomic<bool> stop{false};
+    std::thread collector([&]{
+        while (!stop.load()) {
+            volatile std::size_t n = trace.str().size();
+            (void)n;
+            trace.clear();
+            std::this_thread::sleep_for(1ms);
+        }
+    });
+    std::uint64_t ops = runThreads(threads, d, [&](unsigned){ trace.append("span:db.query;"); });
+    stop.store(true);
+    collector.join();
+    return mops(ops, d);
+}
+
+void benchShardedAppend() {
+    std::cout << "\n===== benchShardedAppend: Mops/s of append(), collector str()+clear() @1kHz =====\n";
+    std::cout << std::setw(8) << "threads" << std::setw(14) << "MutexString"
+              << std::setw(22) << "CombiningMutexString" << std::setw(20) << "ShardedMutexString" << "\n";
+    constexpr auto d = 300ms;
+    for (unsigned n : threadCounts(std::max(8u, std::thread::hardware_concurrency()))) {
+        std::cout << std::setw(8) << n << std::fixed << std::setprecision(2)
+                  << std::setw(14) << accumulate<j2::MutexString>(n, d)
+                  << std::setw(22) << accumulate<j2::CombiningMutexString>(n, d)
+                  << std::setw(20) << accumulate<j2::ShardedMutexString>(n, d) << "\n";
+    }
+}
+
+//---------------------------------------------------------------------------
+// long value read by N threads while one writer keeps appending (and resetting to 64 KiB);
+// reports reader and writer throughput
+template <typename S, typename Read>
+static PollResult readLongValue(unsigned readers, std::chrono::milliseconds d, Read read) {
+    const std::string base(64 * 1024, 'v');
+    S ms = base;
+    std::atomic<bool> stop{false};
+    std::uint64_t writes = 0;
+    std::thread writer([&]{
+        while (!stop.load(std::memory_order_relaxed)) {
+            ms.append("w");
+            if ((++writes & 1023) == 0) ms = base;
+        }
+    });
+    std::uint64_t reads = runThreads(readers, d, [&](unsigned){ read(ms); });
+    stop.store(true);
+    writer.join();
+    return {mops(reads, d), mops(writes, d)};
+}
+
+void benchCowSnapshot() {
+    std::cout << "\n===== benchCowSnapshot: Mops/s readers / writer, 64 KiB value =====\n";
+    std::cout << std::setw(8) << "threads" << std::setw(28) << "str() under lock (r/w)"
+              << std::setw(26) << "snapshot() COW (r/w)" << "\n";
+    using CopyString = j2::BasicMutexString<std::mutex, j2::feature::none>;
+    constexpr auto d = 300ms;
+    for (unsigned n : threadCounts()) {
+        auto copy = readLongValue<CopyString>(n, d, [](const CopyString& ms) {
+            volatile std::size_t sink = ms.str().size();
+            (void)sink;
+        });
+        auto cow = readLongValue<j2::MutexString>(n, d, [](const j2::MutexString& ms) {
+            auto snap = ms.snapshot();
+            volatile std::size_t sink = snap.size();
+            (void)sink;
+        });
+        std::cout << std::setw(8) << n << std::fixed << std::setprecision(2)
+                  << std::setw(14) << copy.poll_mops << std::setw(14) << copy.write_mops
+                  << std::setw(13) << cow.poll_mops << std::setw(13) << cow.write_mops << "\n";
+    }
+}
+
+//---------------------------------------------------------------------------
+// parser pattern: split "k0=v0;k1=v1;..." (32 fields) and touch every value
+static std::string makeMessage() {
+    std::string m;
+    for (int i = 0; i < 32; ++i) m += "field" + std::to_string(i) + "=value-" + std::to_string(i * 7919) + ";";
+    return m;
+}
+
+template <typename S>
+static std::size_t parseWithSubstr(const S& ms, std::size_t len) {
+    std::size_t sum = 0;
+    for (std::size_t pos = 0; pos < len;) {
+        std::size_t eq = ms.find('=', pos);
+        std::size_t semi = ms.find(';', eq);
+        sum += ms.substr(eq + 1, semi - eq - 1).size();   // lock + allocation per field
+        pos = semi + 1;
+    }
+    return sum;
+}
+
+template <typename S>
+static std::size_t parseWithViews(const S& ms) {
+    auto msg = ms.views();                                 // one lock, one pin
+    std::string_view v = msg.view();
+    std::size_t sum = 0;
+    for (std::size_t pos = 0; pos < v.size();) {
+        std::size_t eq = v.find('=', pos);
+        std::size_t semi = v.find(';', eq);
+        sum += v.substr(eq + 1, semi - eq - 1).size();
+        pos = semi + 1;
+    }
+    return sum;
+}
+
+void benchSubstrViews() {
+    std::cout << "\n===== benchSubstrViews: messages/s (x1000), 32 fields per message =====\n";
+    std::cout << std::setw(8) << "threads" << std::setw(14) << "substr()" << std::setw(14) << "views()" << "\n";
+    constexpr auto d = 300ms;
+    const std::string m = makeMessage();
+    j2::MutexString ms = m;
+    for (unsigned n : threadCounts()) {
+        std::uint64_t a = runThreads(n, d, [&](unsigned){
+            volatile std::size_t sink = parseWithSubstr(ms, m.size());
+            (void)sink;
+        });
+        std::uint64_t b = runThreads(n, d, [&](unsigned){
+            volatile std::size_t sink = parseWithViews(ms);
+            (void)sink;
+        });
+        std::cout << std::setw(8) << n << std::fixed << std::setprecision(1)
+                  << std::setw(14) << mops(a, d) * 1000.0 << std::setw(14) << mops(b, d) * 1000.0 << "\n";
+    }
+}
+
+//---------------------------------------------------------------------------
+// build-then-read request: 8 fields, each assembled from 16 appends, then searched and compared;
+// every field is destroyed at the end of the request
+static constexpr int kRequestFields = 8;
+
+template <typename S, typename... Args>
+static std::size_t buildThenRead(const Args&... args) {
+    std::optional<S> fields[kRequestFields];
+    for (auto& f : fields) {
+        f.emplace(args...);
+        for (int i = 0; i < 16; ++i) f->append("chunk-of-text;");
+    }
+    std::size_t sum = 0;
+    for (auto& f : fields) sum += f->find("text;c", 100) + f->size() + (*f == "x");
+    return sum;
+}
+
+// per-thread backing store: a stack-like buffer for the arena, then a pool if a request outgrows it
+struct ThreadArena {
+    alignas(64) std::byte buf[16 * 1024];
+    std::pmr::unsynchronized_pool_resource pool;
+};
+
+void benchPmrArena() {
+    std::cout << "\n===== benchPmrArena: requests/s (x1000), 8 fields x 16 appends =====\n";
+    std::cout << std::setw(8) << "threads" << std::setw(14) << "heap" << std::setw(14) << "arena" << "\n";
+    constexpr auto d = 300ms;
+    for (unsigned n : threadCounts()) {
+        std::uint64_t heap = runThreads(n, d, [](unsigned){
+            volatile std::size_t sink = buildThenRead<j2::MutexString>();
+            (void)sink;
+        });
+        std::vector<std::unique_ptr<ThreadArena>> arenas;
+        for (unsigned t = 0; t < n; ++t) arenas.push_back(std::make_unique<ThreadArena>());
+        std::uint64_t arena = runThreads(n, d, [&](unsigned t){
+            ThreadArena& ta = *arenas[t];
+            std::pmr::monotonic_buffer_resource req(ta.buf, sizeof(ta.buf), &ta.pool);   // released in one step
+            volatile std::size_t sink = buildThenRead<j2::PmrMutexString>(&req);
+            (void)sink;
+        });
+        std::cout << std::setw(8) << n << std::fixed << std::setprecision(1)
+                  << std::setw(14) << mops(heap, d) * 1000.0 << std::setw(14) << mops(arena, d) * 1000.0 << "\n";
+    }
+}
+
+//---------------------------------------------------------------------------
+// short-lived labels: construct, assign a 20-60 char value, compare, destroy
+template <typename S>
+static std::size_t labelRound(const char* const* values, std::size_t count) {
+    std::size_t hits = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        S label;
+        label = values[i];
+        hits += (label == values[(i + 1) % count]);
+    }
+    return hits;
+}
+
+void benchInlineAssign() {
+    std::cout << "\n===== benchInlineAssign: labels/s (x1000), values of 20-60 chars =====\n";
+    std::cout << std::setw(8) << "threads" << std::setw(14) << "MutexString" << std::setw(14) << "Inline<64>" << "\n";
+    constexpr auto d = 300ms;
+    static const char* const values[] = {
+        "api-7.eu-west-1.example.internal",
+        "tenant-0f3a9c2e-5b71-4d0e-9a1c",
+        "status: degraded (replica lag 1200ms, 3 retries)",
+        "checkout-service-canary-2024-10-rollout-group-b-eu",
+    };
+    constexpr std::size_t count = sizeof(values) / sizeof(values[0]);
+    for (unsigned n : threadCounts()) {
+        std::uint64_t heap = runThreads(n, d, [](unsigned){
+            volatile std::size_t sink = labelRound<j2::MutexString>(values, count);
+            (void)sink;
+        });
+        std::uint64_t inl = runThreads(n, d, [](unsigned){
+            volatile std::size_t sink = labelRound<j2::InlineMutexString<64>>(values, count);
+            (void)sink;
+        });
+        std::cout << std::setw(8) << n << std::fixed << std::setprecision(1)
+                  << std::setw(14) << mops(heap, d) * 1000.0 * count << std::setw(14) << mops(inl, d) * 1000.0 * count << "\n";
+    }
+}
+
+//---------------------------------------------------------------------------
+// per-thread counters kept next to each other: thread t only touches element t,
+// so any slowdown with more threads comes from neighbours sharing cache lines
+template <typename S>
+static double neighbourAppends(unsigned threads, std::chrono::milliseconds d) {
+    std::vector<S> slots(threads);
+    std::uint64_t ops = runThreads(threads, d, [&](unsigned t){
+        S& mine = slots[t];
+        mine.append("x");
+        if (mine.size() >= 4096) mine.clear();
+    });
+    return mops(ops, d);
+}
+
+void benchFalseSharing() {
+    std::cout << "\n===== benchFalseSharing: Mops/s, thread t appends to slots[t] =====\n";
+    std::cout << "sizeof: MutexString=" << sizeof(j2::MutexString)
+              << ", AlignedMutexString=" << sizeof(j2::AlignedMutexString) << "\n";
+    std::cout << std::setw(8) << "threads" << std::setw(14) << "packed" << std::setw(14) << "aligned" << "\n";
+    constexpr auto d = 300ms;
+    for (unsigned n : threadCounts()) {
+        double packed = neighbourAppends<j2::MutexString>(n, d);
+        double aligned = neighbourAppends<j2::AlignedMutexString>(n, d);
+        std::cout << std::setw(8) << n << std::fixed << std::setprecision(2)
+                  << std::setw(14) << packed << std::setw(14) << aligned << "\n";
+    }
+}
+
+//---------------------------------------------------------------------------
+// single-thread scan speed of the search kernels (what find()/rfind() run under the lock)
+// - haystack of lowercase words, needle taken from the far end so every call scans (nearly) the whole string
+// - GB/s of haystack scanned per call; the level columns stop at what this CPU supports
+static double scanRate(std::string_view hay, const std::function<std::size_t()>& search) {
+    std::size_t calls = 0;
+    volatile std::size_t sink = 0;
+    const auto start = bench_clock::now();
+    auto elapsed = bench_clock::duration::zero();
+    do {
+        for (int i = 0; i < 64; ++i) sink = sink + search();
+        calls += 64;
+        elapsed = bench_clock::now() - start;
+    } while (elapsed < 20ms);
+    return static_cast<double>(hay.size()) * calls / std::chrono::duration<double>(elapsed).count() / 1e9;
+}
+
+static std::string makeWords(std::size_t n) {
+    std::string s;
+    std::uint32_t x = 12345;
+    while (s.size() < n) {
+        x = x * 1103515245u + 12345u;
+        s.push_back((x >> 16) % 6 == 0 ? ' ' : static_cast<char>('a' + (x >> 20) % 26));
+    }
+    return s;
+}
+
+void benchFind() {
+    std::cout << "\n===== benchFind: GB/s scanned, needle at the far end (CPU: " << j2::to_string(j2::simd_level()) << ") =====\n";
+    static const j2::SimdLevel levels[] = {j2::SimdLevel::sse2, j2::SimdLevel::avx2, j2::SimdLevel::avx512};
+    std::cout << std::setw(6) << "op" << std::setw(10) << "haystack" << std::setw(8) << "needle" << std::setw(10) << "std";
+    for (j2::SimdLevel l : levels) if (l <= j2::simd_level()) std::cout << std::setw(10) << j2::to_string(l);
+    std::cout << "\n";
+    for (std::size_t hn : {64, 1024, 4096, 65536}) {
+        for (std::size_t nn : {1, 4, 16, 64}) {
+            if (nn * 2 > hn) continue;
+            for (bool reverse : {false, true}) {
+                // a word-like needle taken from the far end (its first/last chars are common in the text);
+                // a single char is one that never occurs elsewhere
+                std::string hay = makeWords(hn);
+                if (nn == 1) hay[reverse ? 0 : hn - 1] = 'Q';
+                const std::string needle = reverse ? hay.substr(0, nn) : hay.substr(hn - nn);
+                const std::string_view h(hay), nd(needle);
+                std::cout << std::setw(6) << (reverse ? "rfind" : "find") << std::setw(10) << hn << std::setw(8) << nn
+                          << std::fixed << std::setprecision(2) << std::setw(10)
+                          << scanRate(h, [&] { return reverse ? h.rfind(nd) : h.find(nd); });
+                for (j2::SimdLevel l : levels) {
+                    if (l > j2::simd_level()) continue;
+                    const j2::detail::SearchKernels& k = j2::detail::search_kernels(l);
+                    std::cout << std::setw(10) << scanRate(h, [&] { return reverse ? k.rfind(h, nd, std::string_view::npos) : k.find(h, nd, 0); });
+                }
+                std::cout << "\n";
+            }
+        }
+    }
+}
+
+// haystacks up to 300 bytes (several vector blocks plus a tail), needles up to 70 bytes (longer than one
+// AVX-512 block), positions past the end and npos; small alphabets so the candidate filter fires often
+void checkSearchKernels() {
+    static const std::string_view alphabet = "abcd/ \x80\xff";
+    std::size_t cases = 0;
+    for (j2::SimdLevel l : supportedLevels()) {
+        const j2::detail::SearchKernels& k = j2::detail::search_kernels(l);
+        const std::string level = j2::to_string(l);
+        std::mt19937& rng = checkRng();
+        for (int i = 0; i < 20000; ++i, ++cases) {
+            const std::size_t letters = 1 + rng() % alphabet.size();
+            const std::string hay = randomText(rng() % 300, alphabet, letters);
+            std::string needle = randomText(rng() % 8, alphabet, letters);
+            if (rng() % 4 == 0 && !hay.empty()) needle = hay.substr(rng() % hay.size(), rng() % 70);
+            const std::size_t pos = rng() % 4 == 0 ? std::string_view::npos : rng() % (hay.size() + 3);
+            const char ch = alphabet[rng() % alphabet.size()];
+            const std::string_view h(hay), nd(needle);
+            expectSame(k.find(h, nd, pos), h.find(nd, pos), level + " find", h, nd, pos);
+            expectSame(k.rfind(h, nd, pos), h.rfind(nd, pos), level + " rfind", h, nd, pos);
+            expectSame(k.find_char(h, ch, pos), h.find(ch, pos), level + " find(char)", h, std::string_view(&ch, 1), pos);
+            expectSame(k.rfind_char(h, ch, pos), h.rfind(ch, pos), level + " rfind(char)", h, std::string_view(&ch, 1), pos);
+        }
+    }
+    std::cout << "checkSearchKernels: " << cases << " cases OK (levels up to " << j2::to_string(j2::simd_level()) << ")\n";
+}
+
+//---------------------------------------------------------------------------
+// byte-set scans (tokenizers): no member until the far end / only members until the far end
+void benchFindOf() {
+    std::cout << "\n===== benchFindOf: GB/s scanned, match at the far end (CPU: " << j2::to_string(j2::simd_level()) << ") =====\n";
+    static const j2::SimdLevel levels[] = {j2::SimdLevel::scalar, j2::SimdLevel::avx2, j2::SimdLevel::avx512};
+    std::cout << std::setw(14) << "op" << std::setw(10) << "haystack" << std::setw(6) << "set" << std::setw(10) << "std";
+    for (j2::SimdLevel l : levels) if (l <= j2::simd_level()) std::cout << std::setw(10) << j2::to_string(l);
+    std::cout << "\n";
+    for (std::size_t hn : {64, 4096, 65536}) {
+        for (std::size_t sn : {1, 4, 16}) {
+            for (bool negate : {false, true}) {
+                // first_of: set of chars absent from the text but the last byte; first_not_of: the text is all set members
+                const std::string set = std::string("QWERTYUIOPASDFGH").substr(0, sn);
+                std::string hay = negate ? std::string(hn, set[0]) : makeWords(hn);
+                hay.back() = negate ? '.' : set.back();
+                const std::string_view h(hay), s(set);
+                const j2::detail::CharSet cs(s);
+                std::cout << std::setw(14) << (negate ? "first_not_of" : "first_of") << std::setw(10) << hn << std::setw(6) << sn
+                          << std::fixed << std::setprecision(2) << std::setw(10)
+                          << scanRate(h, [&] { return negate ? h.find_first_not_of(s) : h.find_first_of(s); });
+                for (j2::SimdLevel l : levels) {
+                    if (l > j2::simd_level()) continue;
+                    const j2::detail::SearchKernels& k = j2::detail::search_kernels(l);
+                    std::cout << std::setw(10) << scanRate(h, [&] { return k.find_of(h, cs, !negate, 0); });
+                }
+                std::cout << "\n";
+            }
+        }
+    }
+}
+
+// sets of 0-8 bytes drawn from 6 letters (members and non-members interleave) or from all 256 bytes
+// (both nibble halves of the shuffle tables, bytes >= 0x80)
+void checkFindOf() {
+    std::string all(256, '\0');
+    for (std::size_t i = 0; i < all.size(); ++i) all[i] = static_cast<char>(i);
+    std::size_t cases = 0;
+    for (j2::SimdLevel l : supportedLevels()) {
+        const j2::detail::SearchKernels& k = j2::detail::search_kernels(l);
+        const std::string level = j2::to_string(l);
+        std::mt19937& rng = checkRng();
+        for (int i = 0; i < 20000; ++i, ++cases) {
+            const std::string_view alphabet = rng() % 2 ? std::string_view(all) : std::string_view("abcdef");
+            const std::string hay = randomText(rng() % 300, alphabet, alphabet.size());
+            const std::string set = randomText(rng() % 9, alphabet, alphabet.size());
+            const std::size_t pos = rng() % 4 == 0 ? std::string_view::npos : rng() % (hay.size() + 3);
+            const std::string_view h(hay), s(set);
+            const j2::detail::CharSet cs(s);
+            expectSame(k.find_of(h, cs, true, pos), h.find_first_of(s, pos), level + " find_first_of", h, s, pos);
+            expectSame(k.find_of(h, cs, false, pos), h.find_first_not_of(s, pos), level + " find_first_not_of", h, s, pos);
+            expectSame(k.rfind_of(h, cs, true, pos), h.find_last_of(s, pos), level + " find_last_of", h, s, pos);
+            expectSame(k.rfind_of(h, cs, false, pos), h.find_last_not_of(s, pos), level + " find_last_not_of", h, s, pos);
+        }
+    }
+    std::cout << "checkFindOf: " << cases << " cases OK\n";
+}
+
+//---------------------------------------------------------------------------
+// "does the value contain any of these keywords?" on a 64 KiB value
+// - find() per keyword: one read lock and one full scan per keyword
+// - find_any(PatternSet): one read lock and one pass for all of them (set compiled once, outside the loop)
+// - keywords are random 8-letter words that do not occur, so both sides scan everything; us per question
+static double usPerQuestion(const std::function<std::size_t()>& ask) {
+    std::size_t calls = 0;
+    volatile std::size_t sink = 0;
+    const auto start = bench_clock::now();
+    auto elapsed = bench_clock::duration::zero();
+    do {
+        sink = sink + ask();
+        ++calls;
+        elapsed = bench_clock::now() - start;
+    } while (elapsed < 50ms);
+    return std::chrono::duration<double, std::micro>(elapsed).count() / calls;
+}
+
+void benchPatternSet() {
+    std::cout << "\n===== benchPatternSet: any of K keywords in a 64 KiB value, us per question =====\n";
+    std::cout << std::setw(10) << "keywords" << std::setw(14) << "find() x K" << std::setw(12) << "find_any" << std::setw(10) << "states" << "\n";
+    const std::string text = makeWords(64 * 1024);
+    j2::MutexString ms(text);
+    for (std::size_t k : {1, 10, 100, 500}) {
+        std::vector<std::string> words;
+        std::uint32_t x = 777;
+        while (words.size() < k) {
+            std::string w;
+            for (int i = 0; i < 8; ++i) {
+                x = x * 1103515245u + 12345u;
+                w.push_back(static_cast<char>('a' + (x >> 16) % 26));
+            }
+            if (text.find(w) == std::string::npos) words.push_back(std::move(w));
+        }
+        const j2::PatternSet set(words);
+        const double each = usPerQuestion([&] {
+            for (const std::string& w : words) {
+                if (const std::size_t at = ms.find(w); at != std::string::npos) return at;
+            }
+            return std::string::npos;
+        });
+        const double once = usPerQuestion([&] {
+            const auto m = ms.find_any(set);
+            return m ? m->offset : std::string::npos;
+        });
+        std::cout << std::setw(10) << k << std::fixed << std::setprecision(1) << std::setw(14) << each
+                  << std::setw(12) << once << std::setw(10) << set.states() << "\n";
+    }
+}
+
+// 1-12 patterns of 1-5 letters over 2-5 letters (shared prefixes and suffixes, patterns inside patterns,
+// duplicates); the reference lists matches by end position, longest first, then construction order
+void checkPatternSet() {
+    std::mt19937& rng = checkRng();
+    std::size_t cases = 0;
+    for (int i = 0; i < 3000; ++i, ++cases) {
+        const std::size_t letters = 2 + rng() % 4;
+        std::vector<std::string> patterns(1 + rng() % 12);
+        for (std::string& p : patterns) p = randomText(1 + rng() % 5, "abcdef", letters);
+        if (i % 7 == 0) patterns.push_back(patterns.front());
+        const j2::PatternSet set(patterns);
+        const std::string text = randomText(rng() % 200, "abcdef", letters + 1);
+        const std::size_t pos = rng() % (text.size() + 2);
+
+        std::vector<j2::PatternMatch> expected;
+        for (std::size_t end = pos + 1; end <= text.size(); ++end) {
+            std::vector<j2::PatternMatch> here;
+            for (std::size_t p = 0; p < patterns.size(); ++p) {
+                const std::size_t n = patterns[p].size();
+                if (end >= pos + n && text.compare(end - n, n, patterns[p]) == 0) here.push_back({end - n, n, p});
+            }
+            std::stable_sort(here.begin(), here.end(), [](const j2::PatternMatch& a, const j2::PatternMatch& b) { return a.length > b.length; });
+            expected.insert(expected.end(), here.begin(), here.end());
+        }
+
+        std::string joined;
+        for (const std::string& p : patterns) joined += (joined.empty() ? "" : "|") + p;
+        const std::vector<j2::PatternMatch> all = set.find_all(text, pos);
+        expectSame(all.size(), expected.size(), "PatternSet find_all() size", text, joined, pos);
+        for (std::size_t m = 0; m < all.size(); ++m) {
+            expectSame(all[m].offset, expected[m].offset, "PatternSet find_all() offset", text, joined, pos);
+            expectSame(all[m].length, expected[m].length, "PatternSet find_all() length", text, joined, pos);
+            expectSame(all[m].pattern, expected[m].pattern, "PatternSet find_all() pattern", text, joined, pos);
+        }
+        const std::optional<j2::PatternMatch> any = set.find_any(text, pos);
+        expectSame(any ? any->offset : std::string_view::npos, expected.empty() ? std::string_view::npos : expected[0].offset,
+                   "PatternSet find_any()", text, joined, pos);
+        expectSame(any ? any->pattern : 0, expected.empty() ? 0 : expected[0].pattern, "PatternSet find_any() pattern", text, joined, pos);
+        expectSame(set.count(text, pos), expected.size(), "PatternSet count()", text, joined, pos);
+    }
+    std::cout << "checkPatternSet: " << cases << " cases OK\n";
+}
+
+//---------------------------------------------------------------------------
+// 64 MiB value, needle at the far end: find() (one thread, lock held for the whole scan)
+// vs parallel_find() (lock held only to pin a snapshot, chunks searched on the pool); GB/s
+void benchParallelFind() {
+    std::cout << "\n===== benchParallelFind: 64 MiB value, GB/s (" << std::thread::hardware_concurrency() << " cores) =====\n";
+    std::string text = makeWords(64 << 20);
+    text.replace(text.size() - 12, 12, "needle-12345");
+    const j2::MutexString ms(std::move(text));
+    const double kb = static_cast<double>(ms.size()) / 1e3;   // kb / us = GB/s
+    std::cout << std::setw(14) << "find()" << std::fixed << std::setprecision(2) << std::setw(10)
+              << kb / usPerQuestion([&] { return ms.find("needle-12345"); }) << "\n";
+    for (unsigned threads : {1u, 2u, 4u, 8u}) {
+        j2::ParallelOptions options;
+        options.threads = threads;
+        std::cout << std::setw(13) << "parallel x" << threads << std::setw(10)
+                  << kb / usPerQuestion([&] { return ms.parallel_find("needle-12345", 0, options); }) << "\n";
+    }
+}
+
+// min_chunk of 1-64 bytes splits a text of up to 4 KiB into many chunks, so needles of up to 40 bytes
+// often straddle a border; 1-8 threads
+void checkParallelFind() {
+    std::mt19937& rng = checkRng();
+    std::size_t cases = 0;
+    for (int i = 0; i < 2000; ++i, ++cases) {
+        const std::size_t letters = 1 + rng() % 3;
+        const std::string text = randomText(rng() % 4096, "abc", letters);
+        std::string needle = randomText(rng() % 6, "abc", letters);
+        if (rng() % 2 == 0 && !text.empty()) needle = text.substr(rng() % text.size(), rng() % 40);
+        const std::size_t pos = rng() % 8 == 0 ? std::string_view::npos : rng() % (text.size() + 3);
+        j2::ParallelOptions options;
+        options.threads = 1 + rng() % 8;
+        options.min_chunk = 1 + rng() % 64;
+        const std::string_view t(text), nd(needle);
+        std::size_t expected = nd.empty() ? t.size() + 1 : 0;
+        for (std::size_t at = nd.empty() ? std::string_view::npos : t.find(nd); at != std::string_view::npos; at = t.find(nd, at + 1)) ++expected;
+        expectSame(j2::parallel_find(t, nd, pos, options), t.find(nd, pos), "parallel_find", t, nd, pos);
+        expectSame(j2::parallel_count(t, nd, options), expected, "parallel_count", t, nd, 0);
+    }
+    // a thread count far past the cores: more chunks, no more workers than the cores
+    {
+        const std::string text = randomText(4096, "ab", 2);
+        j2::ParallelOptions options;
+        options.threads = 100000;
+        options.min_chunk = 1;
+        const std::string_view t(text);
+        expectSame(j2::parallel_find(t, "abba", 0, options), t.find("abba"), "parallel_find, 100000 threads", t, "abba", 0);
+        ++cases;
+    }
+    std::cout << "checkParallelFind: " << cases << " cases OK\n";
+}
+
+//---------------------------------------------------------------------------
+// URL log lines, needle at the far end: find(needle) filters on its first and last byte,
+// find(Searcher) on its two rarest bytes; GB/s on a 1 MiB value, ns per call on a 96-byte route
+static std::string makeRoutes(std::size_t n) {
+    static const char* const parts[] = {"/api/", "v1/", "orders/", "items/", "user/", "search?q=", "id=", "&page="};
+    std::string s;
+    std::uint32_t x = 4242;
+    while (s.size() < n) {
+        x = x * 1103515245u + 12345u;
+        s += parts[(x >> 16) % 8];
+        s += std::to_string((x >> 8) % 1000);
+        if ((x >> 20) % 4 == 0) s += " /";
+    }
+    s.resize(n);
+    return s;
+}
+
+// find_pair() of every level with random distinct offsets r1, r2 (not only the ones a Searcher would pick),
+// then Searcher find()/count() with the built-in ranking and with frequencies sampled from the text
+void checkSearcher() {
+    static const std::string_view alphabet = "ab/?.Z\x80\xff";
+    std::size_t cases = 0;
+    for (j2::SimdLevel l : supportedLevels()) {
+        const j2::detail::SearchKernels& k = j2::detail::search_kernels(l);
+        const std::string level = j2::to_string(l);
+        std::mt19937& rng = checkRng();
+        for (int i = 0; i < 20000; ++i, ++cases) {
+            const std::size_t letters = 2 + rng() % (alphabet.size() - 1);
+            std::string hay = randomText(rng() % 300, alphabet, letters);
+            const std::string needle = randomText(rng() % 10 == 0 ? rng() % 100 : rng() % 8, alphabet, letters);
+            if (rng() % 2 == 0 && !needle.empty() && needle.size() <= hay.size()) {
+                hay.replace(rng() % (hay.size() - needle.size() + 1), needle.size(), needle);
+            }
+            const std::size_t pos = rng() % (hay.size() + 3);
+            const std::string_view h(hay), nd(needle);
+            if (nd.size() >= 2) {
+                const std::size_t r1 = rng() % nd.size();
+                const std::size_t r2 = (r1 + 1 + rng() % (nd.size() - 1)) % nd.size();
+                expectSame(k.find_pair(h, nd, r1, r2, pos), h.find(nd, pos),
+                           level + " find_pair(" + std::to_string(r1) + ", " + std::to_string(r2) + ")", h, nd, pos);
+            }
+            if (l != j2::simd_level()) continue;   // a Searcher always runs the kernels of simd_level()
+            std::size_t expected = 0;
+            if (nd.empty()) {
+                expected = pos <= h.size() ? h.size() - pos + 1 : 0;
+            } else {
+                for (std::size_t at = h.find(nd, pos); at != std::string_view::npos; at = h.find(nd, at + 1)) ++expected;
+            }
+            const j2::Searcher ranked(nd), sampled(nd, h);
+            expectSame(ranked.find(h, pos), h.find(nd, pos), "Searcher find", h, nd, pos);
+            expectSame(sampled.find(h, pos), h.find(nd, pos), "Searcher(sample) find", h, nd, pos);
+            expectSame(ranked.count(h, pos), expected, "Searcher count", h, nd, pos);
+        }
+    }
+    std::cout << "checkSearcher: " << cases << " cases OK\n";
+}
+
+void benchSearcher() {
+    std::cout << "\n===== benchSearcher: URL text, needle at the far end =====\n";
+    std::cout << std::setw(20) << "needle" << std::setw(11) << "find GB/s" << std::setw(10) << "Searcher"
+              << std::setw(10) << "sampled" << std::setw(10) << "find ns" << std::setw(10) << "Searcher" << "\n";
+    const std::string sample = makeRoutes(64 << 10);
+    for (const char* needle : {"/api/users/", "/v1/orders/", "?q=abc&page=", "/api/v2/items/9999/"}) {
+        const std::size_t k = std::string_view(needle).size();
+        std::string big = makeRoutes(1 << 20), route = makeRoutes(96);
+        big.replace(big.size() - k, k, needle);
+        route.replace(route.size() - k, k, needle);
+        const j2::MutexString bms(std::move(big)), rms(std::move(route));
+        const j2::Searcher searcher(needle), sampled(needle, sample);
+        const double kb = static_cast<double>(bms.size()) / 1e3;   // kb / us = GB/s
+        auto ns = [](auto&& find) {
+            return 1e3 * usPerQuestion([&] {
+                std::size_t sum = 0;
+                for (int i = 0; i < 64; ++i) sum += find();
+                return sum;
+            }) / 64;
+        };
+        std::cout << std::setw(20) << needle << std::fixed << std::setprecision(2)
+                  << std::setw(11) << kb / usPerQuestion([&] { return bms.find(needle); })
+                  << std::setw(10) << kb / usPerQuestion([&] { return bms.find(searcher); })
+                  << std::setw(10) << kb / usPerQuestion([&] { return bms.find(sampled); })
+                  << std::setprecision(1)
+                  << std::setw(10) << ns([&] { return rms.find(needle); })
+                  << std::setw(10) << ns([&] { return rms.find(searcher); }) << "\n";
+    }
+}
+
+//---------------------------------------------------------------------------
+// a pool of its own (not global()), destroyed while Snapshots of an object that held its entry are alive
+void checkInterned() {
+    const std::string text = "tenant-0123456789-abcdefghijklmnop";   // past SSO: the pool's heap buffer is shared
+    auto pool = std::make_unique<j2::InternPool>();
+    const j2::Interned handle = pool->intern(text);
+    j2::MutexString ms(handle), other;
+    other.assign(handle);
+    expectTrue(ms == handle && other == handle, "Interned: objects hold the pool entry");
+    expectTrue(ms.str() == text && other.size() == text.size(), "Interned: value read from the pool entry");
+
+    other.append("!");   // first write copies the entry back into the object
+    expectTrue(other.str() == text + "!" && other != handle, "Interned: write after assign(Interned)");
+    expectTrue(handle.view() == text && ms == handle, "Interned: pool entry unchanged by a write");
+
+    const j2::Snapshot snap = ms.snapshot();
+    const j2::SnapshotView view = ms.views();
+    expectTrue(snap.data() != handle.data(), "Interned: snapshot() copies the pool entry");
+    pool.reset();
+    expectTrue(snap.str() == text && view.view() == text && ms.str() == text, "Interned: Snapshot after the pool is gone");
+    ms.append("?");
+    expectTrue(ms.str() == text + "?" && snap.str() == text, "Interned: write while the Snapshot is held");
+    std::cout << "checkInterned: OK\n";
+}
+
+void checkSnapshotString() {
+    constexpr int kWrites = 2000;
+    j2::SnapshotString ss;
+    const j2::Snapshot empty = ss.snapshot();
+    std::atomic<bool> stop{false}, torn{false};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&] {
+            std::size_t last = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                const j2::Snapshot snap = ss.snapshot();
+                const std::string_view v = snap.view();
+                // every published value is a run of 'x' one longer than the previous one
+                if (v.size() < last || v.find_first_not_of('x') != std::string_view::npos) torn = true;
+                last = v.size();
+            }
+        });
+    }
+    std::vector<std::thread> writers;
+    for (int w = 0; w < 2; ++w) {
+        writers.emplace_back([&] {
+            for (int i = 0; i < kWrites; ++i) {
+                ss.update([&](std::string& s) {
+                    if (ss.size() != s.size()) torn = true;   // reading the object inside update()
+                    s += 'x';
+                });
+            }
+        });
+    }
+    for (auto& t : writers) t.join();
+    stop = true;
+    for (auto& t : readers) t.join();
+    expectTrue(!torn, "SnapshotString: readers and update() see whole published values");
+    expectTrue(ss.size() == 2 * kWrites, "SnapshotString: size after concurrent update()");
+    expectTrue(empty.str().empty(), "SnapshotString: a held Snapshot keeps its value");
+
+    const j2::SnapshotString copy = ss;
+    ss = "next";
+    expectTrue(copy.size() == 2 * kWrites && ss == "next" && copy != "next", "SnapshotString: copy, then assign");
+    std::cout << "checkSnapshotString: OK\n";
+}
+
+//---------------------------------------------------------------------------
+// change listeners (ObservableMutexString); events run on notification_executor() unless stated
+void checkListeners() {
+    // 1) slow listener: 200 quick writes arrive as fewer, merged events that still cover every version once,
+    //    each with the value the object had at its new_version
+    {
+        j2::ObservableMutexString ms;
+        std::mutex m;
+        std::vector<j2::ChangeEvent> events;
+        std::map<std::uint64_t, std::string> expected;   // version -> value right after that write
+        const std::uint64_t start = ms.version();
+        j2::SubscribeOptions options;
+        options.snapshot = true;
+        j2::Subscription sub = ms.subscribe([&](const j2::ChangeEvent& e) {
+            std::this_thread::sleep_for(2ms);
+            std::scoped_lock lock(m);
+            events.push_back(e);
+        }, options);
+        for (int i = 0; i < 200; ++i) {
+            ms.append(std::to_string(i % 10));
+            expected[ms.version()] = ms.str();   // the only writer: version() is this write's version
+        }
+        expectTrue(eventually([&] {
+            std::scoped_lock lock(m);
+            return !events.empty() && events.back().new_version == ms.version();
+        }), "listener: last version never reported");
+        std::scoped_lock lock(m);
+        std::uint64_t prev = start;
+        bool merged = false;
+        for (const j2::ChangeEvent& e : events) {
+            expectTrue(e.old_version == prev && e.new_version > e.old_version, "listener: events not contiguous");
+            expectTrue(e.value && e.value->view() == expected.at(e.new_version), "listener: snapshot is not the value at new_version");
+            merged = merged || e.new_version - e.old_version > 1;
+            prev = e.new_version;
+        }
+        expectTrue(merged && events.size() < 200, "listener: writes during a slow call were not merged");
+    }
+
+    // 2) unsubscribe() from inside the listener returns (no self-deadlock) and stops later calls
+    {
+        j2::ObservableMutexString ms;
+        std::atomic<int> calls{0};
+        std::atomic<bool> returned{false};
+        j2::Subscription sub;
+        sub = ms.subscribe([&](const j2::ChangeEvent&) {
+            ++calls;
+            sub.unsubscribe();
+            returned.store(true, std::memory_order_release);
+        });
+        ms = "first";
+        expectTrue(eventually([&] { return returned.load(std::memory_order_acquire); }), "listener: unsubscribe() from inside deadlocked");
+        ms = "second";
+        ms = "third";
+        std::this_thread::sleep_for(20ms);
+        expectTrue(calls.load() == 1 && !sub.active(), "listener: called after unsubscribe()");
+    }
+
+    // 3) a Subscription outliving its object: events already posted still arrive, unsubscribe() is harmless
+    {
+        std::atomic<int> calls{0};
+        j2::Subscription sub;
+        {
+            j2::ObservableMutexString ms;
+            j2::SubscribeOptions options;
+            options.snapshot = true;
+            sub = ms.subscribe([&](const j2::ChangeEvent& e) {
+                if (e.value && e.value->view() == "gone soon") ++calls;
+            }, options);
+            ms = "gone soon";
+        }
+        expectTrue(eventually([&] { return calls.load() == 1; }), "listener: event of a destroyed object lost");
+        sub.unsubscribe();
+        expectTrue(!sub.active(), "listener: Subscription still active after unsubscribe()");
+    }
+
+    // 4) an executor that throws: that write is not lost, the next event starts at the last reported version
+    {
+        j2::ObservableMutexString ms;
+        std::atomic<bool> fail{true};
+        std::mutex m;
+        std::vector<j2::ChangeEvent> events;
+        j2::SubscribeOptions options;
+        options.executor = [&fail, base = j2::notification_executor()](std::function<void()> task) {
+            if (fail.load()) throw std::runtime_error("queue full");
+            base(std::move(task));
+        };
+        const std::uint64_t start = ms.version();
+        j2::Subscription sub = ms.subscribe([&](const j2::ChangeEvent& e) {
+            std::scoped_lock lock(m);
+            events.push_back(e);
+        }, options);
+        ms = "not posted";
+        fail.store(false);
+        ms = "posted";
+        expectTrue(eventually([&] {
+            std::scoped_lock lock(m);
+            return !events.empty();
+        }), "listener: no event after the executor recovered");
+        std::this_thread::sleep_for(20ms);
+        std::scoped_lock lock(m);
+        expectTrue(events.size() == 1 && events[0].old_version == start && events[0].new_version == ms.version(),
+                   "listener: failed post not re-reported with the next write");
+    }
+    std::cout << "checkListeners: OK\n";
+}
+
+//---------------------------------------------------------------------------
+// waits of feature::versioned (jstr); a waiter that never returns fails the check after 10 s
+void checkVersionWaits() {
+    // runs wait on a thread, writes `write` 20 ms later; the wait must return after that write
+    auto wokenBy = [](const std::function<void()>& wait, const std::function<void()>& write, const char* what) {
+        std::atomic<bool> returned{false}, written{false};
+        std::thread waiter([&] {
+            wait();
+            expectTrue(written.load(), std::string(what) + ": returned before the write");
+            returned.store(true);
+        });
+        std::this_thread::sleep_for(20ms);
+        written.store(true);
+        write();
+        expectTrue(eventually([&] { return returned.load(); }), std::string(what) + ": not woken by a write");
+        waiter.join();
+    };
+
+    jstr ms("v");
+    const std::uint64_t v0 = ms.version();
+    ms.append("1");
+    expectTrue(ms.version() > v0, "version: not bumped by a write");
+
+    // a write wakes the waiter (untimed, and with a timeout too large for the clock)
+    std::uint64_t seen = 0, last = ms.version();
+    wokenBy([&] { seen = ms.wait_for_change(last); }, [&] { ms.append("2"); }, "wait_for_change()");
+    expectTrue(seen > last && seen == ms.version(), "wait_for_change(): wrong version returned");
+    last = ms.version();
+    wokenBy([&] { seen = ms.wait_for_change(last, std::chrono::hours::max()); }, [&] { ms.append("3"); },
+            "wait_for_change(hours::max())");
+    expectTrue(seen > last, "wait_for_change(hours::max()): wrong version returned");
+    wokenBy([&] { ms.wait_until([](const std::string& v) { return v.size() >= 6; }); },
+            [&] { ms.append("4"); ms.append("5"); }, "wait_until()");
+    bool met = false;
+    wokenBy([&] { met = ms.wait_for(std::chrono::nanoseconds::max(), [](const std::string& v) { return v.back() == '6'; }); },
+            [&] { ms.append("6"); }, "wait_for(nanoseconds::max())");
+    expectTrue(met, "wait_for(nanoseconds::max()): predicate reported unmet");
+
+    // a timeout returns last / false, no sooner than the timeout
+    last = ms.version();
+    auto start = bench_clock::now();
+    expectTrue(ms.wait_for_change(last, 30ms) == last && bench_clock::now() - start >= 30ms, "wait_for_change(): timeout");
+    start = bench_clock::now();
+    expectTrue(!ms.wait_for(30ms, [](const std::string& v) { return v.empty(); }) && bench_clock::now() - start >= 30ms,
+               "wait_for(): timeout");
+    expectTrue(ms.wait_for_change(last, -5ms) == last, "wait_for_change(): negative timeout");
+
+    // a predicate that already holds returns at once, whatever the timeout
+    start = bench_clock::now();
+    ms.wait_until([](const std::string& v) { return !v.empty(); });
+    expectTrue(ms.wait_for(std::chrono::hours(1), [](const std::string& v) { return v.front() == 'v'; }) &&
+               bench_clock::now() - start < 1s, "wait_until()/wait_for(): satisfied predicate blocked");
+    expectTrue(ms.wait_for_change(v0, std::chrono::hours(1)) == ms.version(), "wait_for_change(): stale last blocked");
+
+    // combined appends: every request bumps the version, even when another thread applied it
+    j2::CombiningMutexString cms;
+    const std::uint64_t c0 = cms.version();
+    runThreads(8, 50ms, [&](unsigned) {
+        const std::uint64_t before = cms.version();
+        cms.append("x");
+        expectTrue(cms.version() > before, "version: combined append returned before its bump");
+    });
+    expectTrue(cms.version() - c0 >= cms.size(), "version: a combined batch bumped less than once per append");
+    std::cout << "checkVersionWaits: OK\n";
+}
+
+//---------------------------------------------------------------------------
+// LogBuffer: 4 threads append numbered lines; every line must come out once, in per-thread order
+static void expectLines(std::string_view out, unsigned threads, int lines, const char* what) {
+    std::vector<int> next(threads, 0);
+    for (std::size_t at = 0; at < out.size();) {
+        const std::size_t end = out.find('\n', at);
+        expectTrue(end != std::string_view::npos, std::string(what) + ": torn line");
+        const std::string line(out.substr(at, end - at));
+        const std::size_t colon = line.find(':');
+        const unsigned t = static_cast<unsigned>(std::stoul(line.substr(0, colon)));
+        expectTrue(t < threads && std::stoi(line.substr(colon + 1)) == next[t]++, std::string(what) + ": line lost or reordered");
+        at = end + 1;
+    }
+    for (int n : next) expectTrue(n == lines, std::string(what) + ": line count");
+}
+
+void checkLogBuffer() {
+    constexpr unsigned threads = 4;
+    constexpr int lines = 20000;
+    std::atomic<unsigned> finished{0};
+    auto appendLines = [&](j2::LogBuffer& lb) {
+        finished = 0;
+        std::vector<std::thread> ts;
+        for (unsigned t = 0; t < threads; ++t) {
+            ts.emplace_back([&lb, &finished, t] {
+                for (int i = 0; i < lines; ++i) lb.append(std::to_string(t) + ":" + std::to_string(i) + "\n");
+                ++finished;
+            });
+        }
+        return ts;
+    };
+
+    // drain_to() while appending, then drain()/recycle() hand the same two blocks back and forth
+    {
+        j2::LogBuffer lb(4096);
+        std::string out;
+        std::vector<std::thread> ts = appendLines(lb);
+        while (finished < threads) lb.drain_to([&](std::string_view s) { out += s; });
+        for (std::thread& t : ts) t.join();
+        lb.drain_to([&](std::string_view s) { out += s; });
+        expectLines(out, threads, lines, "LogBuffer drain_to()");
+
+        lb.append("a");
+        std::string first = lb.drain();
+        const char* block = first.data();
+        const std::size_t cap = first.capacity();
+        lb.recycle(std::move(first));
+        lb.append("b");
+        lb.recycle(lb.drain());
+        lb.append("c");
+        const std::string third = lb.drain();
+        expectTrue(third == "c" && third.data() == block && third.capacity() == cap, "LogBuffer recycle(): block not reused");
+    }
+
+#if !defined(_WIN32)
+    // flusher into a pipe: a reader thread collects everything; stop_flusher() writes the rest
+    {
+        int fds[2];
+        expectTrue(::pipe(fds) == 0, "LogBuffer: pipe()");
+        std::string piped;
+        std::thread reader([&] {
+            char buf[4096];
+            for (::ssize_t n; (n = ::read(fds[0], buf, sizeof buf)) > 0;) piped.append(buf, static_cast<std::size_t>(n));
+        });
+        {
+            j2::LogBuffer lb(4096);
+            lb.start_flusher({fds[1], 1024, std::chrono::milliseconds(5)});
+            expectTrue(lb.flushing(), "LogBuffer: flushing() after start_flusher()");
+            for (std::thread& t : appendLines(lb)) t.join();
+            lb.stop_flusher();
+            expectTrue(!lb.flushing() && lb.empty() && lb.last_error() == 0, "LogBuffer: state after stop_flusher()");
+            ::close(fds[1]);   // EOF for the reader
+            reader.join();
+            expectTrue(lb.bytes_flushed() == piped.size(), "LogBuffer: bytes_flushed()");
+        }
+        ::close(fds[0]);
+        expectLines(piped, threads, lines, "LogBuffer flusher");
+    }
+
+    // a descriptor that rejects writes: the error is recorded, the buffer dropped, appenders go on
+    {
+        const int fd = ::open("/dev/null", O_RDONLY);
+        expectTrue(fd >= 0, "LogBuffer: open(/dev/null)");
+        j2::LogBuffer lb;
+        lb.start_flusher({fd, 16, std::chrono::milliseconds(5)});
+        lb.append(std::string(100, 'x'));
+        expectTrue(eventually([&] { return lb.last_error() != 0; }), "LogBuffer: failed write not reported");
+        lb.stop_flusher();
+        expectTrue(lb.last_error() == EBADF && lb.bytes_flushed() == 0 && lb.empty(), "LogBuffer: failed write");
+        ::close(fd);
+    }
+#endif
+    std::cout << "checkLogBuffer: OK\n";
+}
+
+//---------------------------------------------------------------------------
+// non-blocking and bounded lock scopes; the busy cases hold a guard on another thread
+class LockHolder {
+public:
+    // holds s.synchronize() (exclusive) or the const one (shared with shared_mutex) until release()
+    template <typename S>
+    LockHolder(S& s, bool exclusive) : t_([this, &s, exclusive] {
+        if (exclusive) { auto g = s.synchronize(); hold_(); }
+        else { auto g = std::as_const(s).synchronize(); hold_(); }
+    }) {
+        expectTrue(eventually([&] { return held_.load(); }), "LockHolder: guard never taken");
+    }
+    ~LockHolder() { release(); }
+    void release() {
+        release_ = true;
+        if (t_.joinable()) t_.join();
+    }
+
+private:
+    void hold_() {
+        held_ = true;
+        while (!release_) std::this_thread::sleep_for(1ms);
+    }
+    std::atomic<bool> held_{false}, release_{false};
+    std::thread t_;
+};
+
+template <typename S>
+static void checkTryLockOf(const char* name) {
+    const std::string what = std::string(name) + " ";
+    S ms("ab");
+    const S& cms = ms;
+    int calls = 0;
+    auto length = [&](const std::string& v) { ++calls; return v.size(); };
+    auto touch = [&](std::string& v) { ++calls; v += "+"; };   // void: try_with() returns bool
+
+    // free lock: f runs, results come back, writes commit
+    expectTrue(ms.try_with([](std::string& v) { v += "c"; return v.size(); }) == std::optional<std::size_t>(3), what + "try_with() free");
+    expectTrue(ms.try_with(touch) && ms == "abc+", what + "try_with(void) free");
+    expectTrue(cms.try_with(length) == std::optional<std::size_t>(4), what + "try_with() const free");
+    expectTrue(ms.with_for(10ms, touch) && cms.with_for(10ms, length) == std::optional<std::size_t>(5), what + "with_for() free");
+    expectTrue(ms.with_until(bench_clock::now() + 10ms, touch) && cms.with_until(bench_clock::now(), length).has_value(),
+               what + "with_until() free");
+    if (auto g = ms.try_guard()) g->push_back('g');
+    else expectTrue(false, what + "try_guard() free");
+    expectTrue(static_cast<bool>(cms.try_guard()), what + "try_guard() const free");
+    expectTrue(ms == "abc+++g", what + "try_guard() write");
+    calls = 0;
+
+    {
+        // exclusive holder: every variant gives up, f never runs, the value is untouched
+        LockHolder holder(ms, true);
+        expectTrue(!ms.try_with(length).has_value() && !ms.try_with(touch), what + "try_with() busy");
+        expectTrue(!cms.try_with(length).has_value(), what + "try_with() const busy");
+        const auto start = bench_clock::now();
+        expectTrue(!ms.with_for(20ms, touch) && !cms.with_for(20ms, length), what + "with_for() busy");
+        expectTrue(bench_clock::now() - start >= 40ms, what + "with_for() gave up before the timeout");
+        expectTrue(!ms.with_until(bench_clock::now() - 1ms, touch) && !cms.with_until(bench_clock::now() + 5ms, length),
+                   what + "with_until() busy");
+        expectTrue(!ms.try_guard() && !cms.try_guard() && calls == 0, what + "try_guard() busy");
+    }
+    {
+        // shared holder: const (read) variants get in alongside it only with a shared LockPolicy
+        LockHolder holder(ms, false);
+        constexpr bool shared = j2::is_shared_lockable_v<typename S::lock_type>;
+        expectTrue(cms.try_with(length).has_value() == shared && cms.with_for(5ms, length).has_value() == shared &&
+                   static_cast<bool>(cms.try_guard()) == shared, what + "const variants next to a reader");
+        expectTrue(!ms.try_with(touch) && !ms.try_guard(), what + "writers next to a reader");
+    }
+    {
+        // the holder lets go after 20 ms: a bounded wait of seconds gets the lock then
+        LockHolder holder(ms, true);
+        std::thread releaser([&] { std::this_thread::sleep_for(20ms); holder.release(); });
+        const auto start = bench_clock::now();
+        expectTrue(ms.with_for(10s, touch) && bench_clock::now() - start >= 15ms, what + "with_for() after a release");
+        releaser.join();
+    }
+    expectTrue(ms == "abc+++g+", what + "final value");
+}
+
+void checkTryLock() {
+    checkTryLockOf<j2::MutexString>("MutexString");
+    checkTryLockOf<j2::SharedMutexString>("SharedMutexString");
+    std::cout << "checkTryLock: OK\n";
+}
+
+//---------------------------------------------------------------------------
+// feature::memory_stats: 100 objects grow like a shadow std::string; process totals return to where they were
+void checkMemoryStats() {
+    constexpr std::size_t objects = 100, appends = 10;
+    const std::string chunk(100, 'm');
+    const j2::MemoryTotals before = j2::memory_totals();
+    std::string shadow;
+    std::size_t heap = 0, reallocs = 0;   // heap block of the shadow, and how often it changed
+    {
+        std::vector<j2::AccountedMutexString> v(objects);
+        expectTrue(j2::memory_totals().instances == before.instances + objects, "memory_totals(): instances");
+        for (std::size_t i = 0; i < appends; ++i) {
+            for (j2::AccountedMutexString& ms : v) ms.append(chunk);
+            shadow.append(chunk);
+            const std::size_t h = shadow.capacity() > j2::detail::sso_capacity<std::string>() ? shadow.capacity() + 1 : 0;
+            if (h != heap && h != 0) ++reallocs;
+            heap = h;
+        }
+        const j2::MemoryUsage u = v.front().memory_usage();
+        expectTrue(u.size == shadow.size() && u.capacity == shadow.capacity() && u.heap_bytes == heap,
+                   "memory_usage(): size/capacity/heap after appends");
+        expectTrue(u.reallocations == reallocs && reallocs > 1, "memory_usage(): reallocation count");
+
+        const j2::MemoryTotals grown = j2::memory_totals();
+        expectTrue(grown.size - before.size == objects * shadow.size() &&
+                   grown.capacity - before.capacity == objects * shadow.capacity() &&
+                   grown.heap_bytes - before.heap_bytes == objects * heap &&
+                   grown.reallocations - before.reallocations == objects * reallocs, "memory_totals(): sums after appends");
+
+        v.front().clear();   // keeps the block: everything becomes slack
+        const j2::MemoryUsage c = v.front().memory_usage();
+        expectTrue(c.size == 0 && c.slack() == shadow.capacity() && c.heap_bytes == heap && c.reallocations == reallocs,
+                   "memory_usage(): slack after clear()");
+        v.front().shrink_to_fit();
+        expectTrue(v.front().memory_usage().heap_bytes == 0, "memory_usage(): heap after shrink_to_fit()");
+
+        std::cout << "checkMemoryStats: " << objects << " objects of " << u.size << " bytes: heap " << u.heap_bytes
+                  << " bytes and " << u.reallocations << " reallocations each; totals " << grown.heap_bytes - before.heap_bytes
+                  << " heap bytes, slack " << grown.slack() - before.slack() << "\n";
+    }
+    const j2::MemoryTotals after = j2::memory_totals();
+    expectTrue(after.instances == before.instances && after.size == before.size && after.capacity == before.capacity &&
+               after.heap_bytes == before.heap_bytes, "memory_totals(): not back after the objects were destroyed");
+    expectTrue(after.reallocations >= before.reallocations + objects * reallocs, "memory_totals(): reallocations are cumulative");
+}
@@ -0,0 +1,127 @@
+#include "ChangeListener.hpp"
+
+#include <condition_variable>
+#include <deque>
+
+namespace j2 {
+
+namespace {
+
+// queue + worker thread behind notification_executor()
+class NotificationQueue {
+public:
+    void post(std::function<void()> task) {
+        {
+            std::scoped_lock lock(m_);
+            if (!started_) {
+                std::thread([this] { run_(); }).detach();   // lives until the process exits
+                started_ = true;
+            }
+            q_.push_back(std::move(task));
+        }
+        cv_.notify_one();
+    }
+
+private:
+    void run_() {
+        std::unique_lock lock(m_);
+        for (;;) {
+            cv_.wait(lock, [this] { return !q_.empty(); });
+            std::function<void()> task = std::move(q_.front());
+            q_.pop_front();
+            lock.unlock();
+            try {
+                task();
+            } catch (...) {
+                // a throwing listener must not stop the deliveries of every other object
+            }
+            lock.lock();
+        }
+    }
+
+    std::mutex m_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> q_;
+    bool started_ = false;
+};
+
+NotificationQueue& notification_queue() {
+    static NotificationQueue* q = new NotificationQueue;   // leaked: the worker may still use it during exit
+    return *q;
+}
+
+} // namespace
+
+ChangeExecutor notification_executor() {
+    return [](std::function<void()> task) { notification_queue().post(std::move(task)); };
+}
+
+// ================= ListenerEntry =================
+void detail::ListenerEntry::deliver() {
+    std::scoped_lock lock(call);   // taken under the call lock: a later event waits for this one to finish
+    std::optional<ChangeEvent> ev;
+    {
+        std::scoped_lock take(pending_m);
+        ev.swap(pending);
+    }
+    if (!ev || !active.load(std::memory_order_acquire)) return;
+    caller.store(std::this_thread::get_id(), std::memory_order_relaxed);
+    struct Reset {
+        std::atomic<std::thread::id>& id;
+        ~Reset() { id.store(std::thread::id(), std::memory_order_relaxed); }
+    } reset{caller};
+    fn(*ev);
+}
+
+void detail::ListenerEntry::cancel() {
+    active.store(false, std::memory_order_release);
+    // from inside fn: the call lock is ours already, and the running call is the caller itself
+    if (caller.load(std::memory_order_relaxed) == std::this_thread::get_id()) return;
+    std::scoped_lock wait(call);   // a delivery that passed the active check finishes before we return
+}
+
+// ================= ListenerSet =================
+bool detail::ListenerSet::wants_snapshot() const noexcept {
+    for (const auto& e : entries) {
+        if (e->snapshot && e->active.load(std::memory_order_relaxed)) return true;
+    }
+    return false;
+}
+
+void detail::ListenerSet::dispatch(std::uint64_t version, const std::optional<Snapshot>& value) noexcept {
+    std::size_t live = 0;
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        std::shared_ptr<ListenerEntry>& e = entries[i];
+        if (!e->active.load(std::memory_order_relaxed)) continue;   // unsubscribed: dropped below
+        bool post = false;
+        {
+            std::scoped_lock lock(e->pending_m);
+            if (!e->pending) {
+                e->pending.emplace();
+                e->pending->old_version = e->last_version;
+                post = true;
+            }
+            e->pending->new_version = version;
+            if (e->snapshot) e->pending->value = value;
+        }
+        bool queued = true;   // merged into the queued event, or posted
+        if (post) {
+            try {
+                auto task = [e] { e->deliver(); };
+                if (e->executor) e->executor(std::move(task));
+                else notification_queue().post(std::move(task));
+            } catch (...) {
+                // not posted: the next event of this listener starts at its last reported version again
+                std::scoped_lock lock(e->pending_m);
+                e->pending.reset();
+                queued = false;
+            }
+        }
+        if (queued) e->last_version = version;
+        if (live != i) entries[live] = std::move(e);
+        ++live;
+    }
+    entries.resize(live);
+}
+
+} // namespace j2
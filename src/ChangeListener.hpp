@@ -0,0 +1,102 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <vector>
+#include <optional>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <cstdint>
+
+#include "Snapshot.hpp"
+
+// j2 namespace
+namespace j2 {
+
+// one notification: the listener's previous version, the version right after the write and, if asked for,
+// the value at that version (writes made while the listener's previous event is still queued are merged
+// into that event: new_version - old_version is then larger than 1, and value is the newest one)
+struct ChangeEvent {
+    std::uint64_t old_version = 0;   // last version reported to this listener (version() at subscribe time at first)
+    std::uint64_t new_version = 0;
+    std::optional<Snapshot> value;   // SubscribeOptions::snapshot only
+};
+
+using ChangeListener = std::function<void(const ChangeEvent&)>;
+
+// runs a task somewhere else: post it to a thread pool, an event loop, ...
+// ⚠️ called by the writer while it holds the object's lock: only enqueue, never run the task inline
+using ChangeExecutor = std::function<void(std::function<void()>)>;
+
+// process-wide serial executor: one background thread (started on first use, never joined) runs the tasks
+// in posting order, so the events of one listener arrive in version order; an exception thrown by a task is dropped
+ChangeExecutor notification_executor();
+
+struct SubscribeOptions {
+    bool snapshot = false;       // attach the value (O(1) with feature::cow_snapshot, a copy otherwise)
+    ChangeExecutor executor;     // empty: notification_executor()
+};
+
+namespace detail {
+
+// one registered listener, shared by the object's listener list, the Subscription and queued deliveries
+struct ListenerEntry {
+    ListenerEntry(ChangeListener f, ChangeExecutor ex, bool snap, std::uint64_t version)
+        : fn(std::move(f)), executor(std::move(ex)), snapshot(snap), last_version(version) {}
+
+    void deliver();                        // on the executor: calls fn with the pending event
+    void cancel();                         // waits for a running call (unless called by that call)
+
+    const ChangeListener fn;
+    const ChangeExecutor executor;
+    const bool snapshot;
+    std::uint64_t last_version;            // under the object's exclusive lock
+    // event posted but not yet taken by deliver(): dispatch() merges later writes into it instead of posting
+    // again, so a slow listener holds at most one queued event (one snapshot) per object
+    std::mutex pending_m;
+    std::optional<ChangeEvent> pending;    // pending_m
+    std::atomic<bool> active{true};
+    std::mutex call;                       // held while fn runs
+    std::atomic<std::thread::id> caller{};
+};
+
+// listeners of one object (feature::notify); the list itself is only touched under the object's exclusive lock
+struct ListenerSet {
+    std::vector<std::shared_ptr<ListenerEntry>> entries;
+
+    bool wants_snapshot() const noexcept;
+    // post one event per active listener (old → version), or merge into its event still queued; drops cancelled
+    // listeners; never throws (an event that cannot be posted, e.g. out of memory, is reported with the next one)
+    void dispatch(std::uint64_t version, const std::optional<Snapshot>& value) noexcept;
+};
+
+} // namespace detail
+
+// handle of one subscribe() call: the listener stays registered while the handle lives
+// - unsubscribe()/destruction stop further calls; a call already running finishes first
+//   (unless unsubscribe() is called from inside that listener)
+// - may outlive the object it was taken from
+class [[nodiscard]] Subscription {
+public:
+    Subscription() = default;
+    explicit Subscription(std::shared_ptr<detail::ListenerEntry> e) : e_(std::move(e)) {}
+    Subscription(Subscription&&) noexcept = default;
+    Subscription& operator=(Subscription&& other) noexcept {
+        if (this != &other) { unsubscribe(); e_ = std::move(other.e_); }
+        return *this;
+    }
+    Subscription(const Subscription&) = delete;
+    Subscription& operator=(const Subscription&) = delete;
+    ~Subscription() { unsubscribe(); }
+
+    void unsubscribe() {
+        if (e_) { e_->cancel(); e_.reset(); }
+    }
+    bool active() const noexcept { return e_ != nullptr; }
+    explicit operator bool() const noexcept { return active(); }
+
+private:
+    std::shared_ptr<detail::ListenerEntry> e_;
+};
+
+} // namespace j2
@@ -0,0 +1,88 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <memory_resource>
+#include <cstddef>
+#include <utility>
+
+#include "MutexString.hpp"
+
+// j2 namespace
+namespace j2 {
+
+namespace detail {
+
+// memory_resource with one in-object block: the first allocation that fits gets it, anything else
+// (a larger value, or a second buffer while the string reallocates) goes to the global heap
+// - used by exactly one std::pmr::string under its owner's lock, so it needs no synchronization
+// - not copyable: the block belongs to the object that contains it
+template <std::size_t Bytes>
+class InlineResource : public std::pmr::memory_resource {
+public:
+    InlineResource() = default;
+    InlineResource(const InlineResource&) = delete;
+    InlineResource& operator=(const InlineResource&) = delete;
+
+protected:
+    std::pmr::memory_resource* inline_resource_() noexcept { return this; }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t align) override {
+        if (!used_ && bytes <= Bytes && align <= alignof(std::max_align_t)) {
+            used_ = true;
+            return buf_;
+        }
+        return std::pmr::new_delete_resource()->allocate(bytes, align);
+    }
+    void do_deallocate(void* p, std::size_t bytes, std::size_t align) override {
+        if (p == buf_) { used_ = false; return; }
+        std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    alignas(std::max_align_t) unsigned char buf_[Bytes];
+    bool used_ = false;
+};
+
+} // namespace detail
+
+// MutexString whose value lives in-object up to N chars (small-buffer variant)
+// - libstdc++ keeps only 15 chars in the std::string SSO buffer; hostnames, tenant IDs and status strings
+//   are usually longer, so every first assignment allocates under the lock
+// - here the value is a std::pmr::string (feature::pmr) reserved to N chars from an in-object block at
+//   construction: values up to N chars never allocate; a longer value spills to the heap and keeps its
+//   capacity afterwards (like std::string, assigning a shorter value does not shrink)
+// - copies and moves copy the characters into the destination's own block
+// - with()/guard() expose std::pmr::string, see feature::pmr in MutexString.hpp
+template <std::size_t N>
+class InlineMutexString : private detail::InlineResource<N + 1>   // constructed before the string it backs
+                        , public BasicMutexString<std::mutex, feature::size_mirror | feature::pmr> {
+    // below this the SSO buffer or the first capacity doubling of std::string already covers the value
+    static_assert(N >= 32, "InlineMutexString needs an inline capacity of at least 32 chars");
+
+    using base_type = BasicMutexString<std::mutex, feature::size_mirror | feature::pmr>;
+
+public:
+    static constexpr std::size_t inline_capacity = N;
+
+    // ===== constructors/assignments =====
+    InlineMutexString() : base_type(this->inline_resource_()) { reserve_inline_(); }
+    InlineMutexString(std::string_view s) : InlineMutexString() { this->s_.assign(s); this->commit_(); }
+    InlineMutexString(const std::string& s) : InlineMutexString(std::string_view(s)) {}
+    InlineMutexString(const char* s) : InlineMutexString(std::string_view(s ? s : "")) {}
+
+    InlineMutexString(const InlineMutexString& other) : InlineMutexString() { base_type::operator=(other); }
+    InlineMutexString(InlineMutexString&& other) noexcept : InlineMutexString() { base_type::operator=(std::move(other)); }
+    InlineMutexString& operator=(const InlineMutexString& other) { base_type::operator=(other); return *this; }
+    InlineMutexString& operator=(InlineMutexString&& other) noexcept { base_type::operator=(std::move(other)); return *this; }
+
+    using base_type::operator=;   // std::string / const char*
+
+private:
+    void reserve_inline_() {
+        this->s_.reserve(N);   // takes the in-object block: N chars + terminator
+        this->commit_();
+    }
+};
+
+} // namespace j2
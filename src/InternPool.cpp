@@ -0,0 +1,96 @@
+#include "InternPool.hpp"
+
+namespace j2 {
+
+namespace {
+
+constexpr std::size_t kInitialSlots = 16;   // per shard, power of two
+
+// slot index: the low bits of the hash already picked the shard
+std::size_t slot_of(std::size_t hash) { return hash / detail::kInternShards; }
+
+} // namespace
+
+InternPool::InternPool() {
+    for (Shard& sh : shards_) {
+        sh.tables.push_back(std::make_unique<detail::InternTable>(kInitialSlots));
+        sh.table.store(sh.tables.back().get(), std::memory_order_release);
+    }
+}
+
+InternPool::~InternPool() = default;
+
+InternPool& InternPool::global() {
+    static InternPool* pool = new InternPool;   // leaked on purpose (see header)
+    return *pool;
+}
+
+// ================= lookup (lock-free) =================
+const detail::InternEntry* InternPool::probe_(const detail::InternTable& t, std::size_t hash, std::string_view s) {
+    for (std::size_t i = slot_of(hash) & t.mask;; i = (i + 1) & t.mask) {
+        const detail::InternEntry* e = t.slots[i].load(std::memory_order_acquire);
+        if (!e) return nullptr;   // tables are at most half full, so a probe always ends on an empty slot
+        if (e->hash == hash && e->value == s) return e;
+    }
+}
+
+std::optional<Interned> InternPool::lookup(std::string_view s) const {
+    if (s.empty()) return Interned{};
+    const std::size_t hash = std::hash<std::string_view>()(s);
+    const Shard& sh = shards_[hash & (detail::kInternShards - 1)];
+    if (const detail::InternEntry* e = probe_(*sh.table.load(std::memory_order_acquire), hash, s)) {
+        return Interned{&e->value};
+    }
+    return std::nullopt;
+}
+
+// ================= insert (shard lock) =================
+void InternPool::place_(detail::InternTable& t, const detail::InternEntry* e) {
+    std::size_t i = slot_of(e->hash) & t.mask;
+    while (t.slots[i].load(std::memory_order_relaxed)) i = (i + 1) & t.mask;
+    t.slots[i].store(e, std::memory_order_release);   // publishes the entry's contents to lock-free readers
+}
+
+Interned InternPool::intern(std::string_view s) {
+    if (s.empty()) return Interned{};
+    const std::size_t hash = std::hash<std::string_view>()(s);
+    Shard& sh = shards_[hash & (detail::kInternShards - 1)];
+
+    // 1) hit: no lock
+    if (const detail::InternEntry* e = probe_(*sh.table.load(std::memory_order_acquire), hash, s)) {
+        return Interned{&e->value};
+    }
+
+    // 2) miss: re-check under the shard lock (another thread may have inserted it, or grown the table)
+    std::scoped_lock lock(sh.write);
+    detail::InternTable* t = sh.table.load(std::memory_order_relaxed);
+    if (const detail::InternEntry* e = probe_(*t, hash, s)) return Interned{&e->value};
+
+    if ((sh.count + 1) * 2 > t->mask + 1) {
+        // keep the load factor at or below 1/2; the old table stays readable for in-flight probes
+        auto bigger = std::make_unique<detail::InternTable>((t->mask + 1) * 2);
+        for (std::size_t i = 0; i <= t->mask; ++i) {
+            if (const detail::InternEntry* e = t->slots[i].load(std::memory_order_relaxed)) place_(*bigger, e);
+        }
+        sh.tables.push_back(std::move(bigger));
+        t = sh.tables.back().get();
+        sh.table.store(t, std::memory_order_release);
+    }
+
+    sh.entries.push_back(detail::InternEntry{hash, std::string(s)});
+    const detail::InternEntry* e = &sh.entries.back();
+    place_(*t, e);
+    ++sh.count;
+    return Interned{&e->value};
+}
+
+std::size_t InternPool::size() const {
+    std::size_t n = 0;
+    for (const Shard& sh : shards_) {
+        std::scoped_lock lock(sh.write);
+        n += sh.count;
+    }
+    return n;
+}
+
+} // namespace j2
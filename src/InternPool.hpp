@@ -0,0 +1,121 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <optional>
+#include <cstddef>
+#include <functional>
+
+// j2 namespace
+namespace j2 {
+
+// handle to a value stored once in an InternPool
+// - copying is a pointer copy; the characters belong to the pool and never change
+// - two handles from the same pool are equal iff they point to the same entry (operator== is a pointer compare)
+// - valid while the pool lives (InternPool::global() is never destroyed)
+// - the default handle is the empty string (intern("") returns it too)
+class Interned {
+public:
+    Interned() = default;
+
+    std::string_view view() const { return p_ ? std::string_view(*p_) : std::string_view(); }
+    operator std::string_view() const { return view(); }
+    const std::string& str() const { return p_ ? *p_ : empty_(); }
+    const char* c_str() const { return str().c_str(); }
+    const char* data() const { return str().data(); }
+    std::size_t size() const { return p_ ? p_->size() : 0; }
+    bool empty() const { return size() == 0; }
+
+    const std::string* get() const { return p_; }
+
+    friend bool operator==(const Interned& a, const Interned& b) { return a.p_ == b.p_; }
+    friend bool operator!=(const Interned& a, const Interned& b) { return a.p_ != b.p_; }
+    friend bool operator==(const Interned& a, std::string_view b) { return a.view() == b; }
+    friend bool operator!=(const Interned& a, std::string_view b) { return a.view() != b; }
+    friend bool operator==(std::string_view a, const Interned& b) { return a == b.view(); }
+    friend bool operator!=(std::string_view a, const Interned& b) { return a != b.view(); }
+
+private:
+    friend class InternPool;
+    explicit Interned(const std::string* p) : p_(p) {}
+
+    static const std::string& empty_() {
+        static const std::string e;
+        return e;
+    }
+
+    const std::string* p_ = nullptr;
+};
+
+namespace detail {
+
+struct InternEntry {
+    std::size_t hash;
+    std::string value;
+};
+
+// open-addressing table of one shard: slots are written once (under the shard lock) and never cleared,
+// a full table is replaced by a larger one and kept until the pool is destroyed (readers may still probe it)
+struct InternTable {
+    explicit InternTable(std::size_t capacity)
+        : mask(capacity - 1), slots(new std::atomic<const InternEntry*>[capacity]) {
+        for (std::size_t i = 0; i < capacity; ++i) slots[i].store(nullptr, std::memory_order_relaxed);
+    }
+    std::size_t mask;
+    std::unique_ptr<std::atomic<const InternEntry*>[]> slots;
+};
+
+inline constexpr std::size_t kInternShards = 64;   // power of two
+
+} // namespace detail
+
+// concurrent string interning pool: every distinct value is stored once
+// - sharded by hash; lookups of values already in the pool are lock-free (atomic loads while probing)
+// - inserting a new value locks its shard only, so threads interning different values rarely meet
+// - values are never removed: use for bounded vocabularies (hostnames, tenant IDs, status strings)
+// - hold the result in an Interned handle, or assign it to a MutexString to share the pool's storage
+class InternPool {
+public:
+    InternPool();
+    ~InternPool();
+    InternPool(const InternPool&) = delete;
+    InternPool& operator=(const InternPool&) = delete;
+
+    // the value's handle, inserting it on first use
+    Interned intern(std::string_view s);
+    // the value's handle if it is already in the pool (never inserts)
+    std::optional<Interned> lookup(std::string_view s) const;
+
+    std::size_t size() const;   // number of distinct values
+
+    // process-wide pool (never destroyed, so handles in static objects stay valid during exit)
+    static InternPool& global();
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<detail::InternTable*> table{nullptr};
+        mutable std::mutex write;                            // inserts and growth
+        std::size_t count = 0;                               // under write
+        std::deque<detail::InternEntry> entries;             // stable addresses
+        std::vector<std::unique_ptr<detail::InternTable>> tables;   // current + replaced tables
+    };
+
+    static const detail::InternEntry* probe_(const detail::InternTable& t, std::size_t hash, std::string_view s);
+    static void place_(detail::InternTable& t, const detail::InternEntry* e);
+
+    Shard shards_[detail::kInternShards];
+};
+
+} // namespace j2
+
+// hash of the entry address: Interned keys in unordered containers never hash the characters
+namespace std {
+template <>
+struct hash<j2::Interned> {
+    std::size_t operator()(const j2::Interned& v) const noexcept { return std::hash<const void*>()(v.get()); }
+};
+} // namespace std
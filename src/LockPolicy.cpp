@@ -0,0 +1,139 @@
+#include "LockPolicy.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>   // WaitOnAddress/WakeByAddress* (link Synchronization.lib)
+#endif
+
+namespace j2 {
+namespace detail {
+
+static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t)
+              && std::atomic<std::uint32_t>::is_always_lock_free,
+              "address-based waiting needs a plain lock-free 32-bit atomic");
+
+#if defined(__linux__)
+
+static std::uint32_t* word_(std::atomic<std::uint32_t>* addr) {
+    return reinterpret_cast<std::uint32_t*>(addr);
+}
+
+void futex_wait(std::atomic<std::uint32_t>* addr, std::uint32_t expected) noexcept {
+    // EAGAIN (value already changed) and EINTR are both "return and re-check"
+    syscall(SYS_futex, word_(addr), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+void futex_wait_for(std::atomic<std::uint32_t>* addr, std::uint32_t expected, std::chrono::nanoseconds timeout) noexcept {
+    if (timeout.count() <= 0) return;
+    timespec ts;
+    ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000000);
+    ts.tv_nsec = static_cast<long>(timeout.count() % 1000000000);
+    syscall(SYS_futex, word_(addr), FUTEX_WAIT_PRIVATE, expected, &ts, nullptr, 0);   // relative timeout
+}
+void futex_wake_one(std::atomic<std::uint32_t>* addr) noexcept {
+    syscall(SYS_futex, word_(addr), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+}
+void futex_wake_all(std::atomic<std::uint32_t>* addr) noexcept {
+    syscall(SYS_futex, word_(addr), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
+
+#elif defined(_WIN32)
+
+void futex_wait(std::atomic<std::uint32_t>* addr, std::uint32_t expected) noexcept {
+    WaitOnAddress(reinterpret_cast<volatile VOID*>(addr), &expected, sizeof(expected), INFINITE);
+}
+void futex_wait_for(std::atomic<std::uint32_t>* addr, std::uint32_t expected, std::chrono::nanoseconds timeout) noexcept {
+    if (timeout.count() <= 0) return;
+    // round up so a short timeout still sleeps instead of spinning through the caller's loop
+    auto ms = std::chrono::ceil<std::chrono::milliseconds>(timeout).count();
+    DWORD wait_ms = ms >= static_cast<long long>(INFINITE) ? INFINITE - 1 : static_cast<DWORD>(ms);
+    WaitOnAddress(reinterpret_cast<volatile VOID*>(addr), &expected, sizeof(expected), wait_ms);
+}
+void futex_wake_one(std::atomic<std::uint32_t>* addr) noexcept {
+    WakeByAddressSingle(reinterpret_cast<PVOID>(addr));
+}
+void futex_wake_all(std::atomic<std::uint32_t>* addr) noexcept {
+    WakeByAddressAll(reinterpret_cast<PVOID>(addr));
+}
+
+#else
+
+// portable fallback: no kernel wait queue, the caller's re-check loop degrades to yielding
+void futex_wait(std::atomic<std::uint32_t>* addr, std::uint32_t expected) noexcept {
+    if (addr->load(std::memory_order_relaxed) == expected) std::this_thread::yield();
+}
+void futex_wait_for(std::atomic<std::uint32_t>* addr, std::uint32_t expected, std::chrono::nanoseconds timeout) noexcept {
+    if (timeout.count() > 0 && addr->load(std::memory_order_relaxed) == expected)
+        std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(timeout, std::chrono::microseconds(50)));
+}
+void futex_wake_one(std::atomic<std::uint32_t>*) noexcept {}
+void futex_wake_all(std::atomic<std::uint32_t>*) noexcept {}
+
+#endif
+
+// ================= parking lot =================
+namespace {
+
+// one cache line per word so parking on one bucket does not disturb its neighbours
+struct alignas(64) ParkingBucket {
+    std::atomic<std::uint32_t> seq{0};
+};
+
+constexpr std::size_t kParkingBuckets = 256;   // power of two
+ParkingBucket g_parking_lot[kParkingBuckets];
+
+} // namespace
+
+std::atomic<std::uint32_t>& parking_word(const void* addr) noexcept {
+    auto h = reinterpret_cast<std::uintptr_t>(addr);
+    h ^= h >> 17;
+    h *= static_cast<std::uintptr_t>(0x9E3779B97F4A7C15ull);
+    return g_parking_lot[(h >> 8) & (kParkingBuckets - 1)].seq;
+}
+
+void unpark_all(const void* addr) noexcept {
+    auto& w = parking_word(addr);
+    w.fetch_add(1, std::memory_order_seq_cst);
+    futex_wake_all(&w);
+}
+
+} // namespace detail
+
+// ================= CompactLock =================
+void CompactLock::lock_slow_() noexcept {
+    // 1) short spin while the owner is running and nobody is parked yet
+    for (unsigned spin = 0; spin < 64; ++spin) {
+        std::uint8_t c = state_.load(std::memory_order_relaxed);
+        if (c & parked_bit) break;
+        if (!(c & locked_bit)
+            && state_.compare_exchange_weak(c, c | locked_bit, std::memory_order_acquire, std::memory_order_relaxed))
+            return;
+        detail::cpu_relax();
+    }
+    // 2) park: once a thread has parked it takes the lock as locked|parked, so the next unlock wakes the rest
+    auto& word = detail::parking_word(this);
+    for (;;) {
+        std::uint32_t seq = word.load(std::memory_order_seq_cst);
+        if (!(state_.exchange(locked_bit | parked_bit, std::memory_order_seq_cst) & locked_bit)) return;
+        detail::futex_wait(&word, seq);
+    }
+}
+
+void CompactLock::unlock_slow_() noexcept {
+    // parked bit set: release, then bump the parking word so a waiter between its seq load and wait returns
+    state_.store(0, std::memory_order_seq_cst);
+    detail::unpark_all(this);
+}
+
+} // namespace j2
@@ -0,0 +1,203 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+// j2 namespace
+namespace j2 {
+
+// lock policies for BasicMutexString
+// - a policy is any type usable with std::scoped_lock / std::unique_lock (lock/try_lock/unlock)
+// - std::mutex (default), std::shared_mutex and the light-weight types below are provided
+// - a policy that also has lock_shared()/unlock_shared() gets shared locking in const members
+
+namespace detail {
+
+// cpu hint inside spin loops (pause on x86, yield on ARM)
+inline void cpu_relax() noexcept {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_pause();
+#elif defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// address-based wait/wake on a 32-bit word (LockPolicy.cpp)
+// - Linux: futex, Windows: WaitOnAddress, elsewhere: yield (callers re-check in a loop)
+// - futex_wait returns when woken, on a spurious wakeup, or immediately if *addr != expected
+void futex_wait(std::atomic<std::uint32_t>* addr, std::uint32_t expected) noexcept;
+// same, but also returns once timeout has elapsed
+void futex_wait_for(std::atomic<std::uint32_t>* addr, std::uint32_t expected, std::chrono::nanoseconds timeout) noexcept;
+void futex_wake_one(std::atomic<std::uint32_t>* addr) noexcept;
+void futex_wake_all(std::atomic<std::uint32_t>* addr) noexcept;
+
+// parking lot (LockPolicy.cpp): a fixed table of 32-bit wait words shared by all objects
+// - any address hashes to one word, so a lock of any size can park without owning a futex word
+// - the word is a wake sequence: a waiter reads it, re-checks its own condition, then waits on it;
+//   a waker changes the condition, bumps the sequence and wakes everybody parked on the word
+std::atomic<std::uint32_t>& parking_word(const void* addr) noexcept;
+void unpark_all(const void* addr) noexcept;
+
+} // namespace detail
+
+// reader-writer detection: a policy with lock_shared()/unlock_shared() (e.g. std::shared_mutex)
+// lets const members of BasicMutexString run concurrently under a shared lock
+template <typename L, typename = void>
+struct is_shared_lockable : std::false_type {};
+template <typename L>
+struct is_shared_lockable<L, std::void_t<decltype(std::declval<L&>().lock_shared()),
+                                         decltype(std::declval<L&>().unlock_shared())>> : std::true_type {};
+template <typename L>
+inline constexpr bool is_shared_lockable_v = is_shared_lockable<L>::value;
+
+// timed-lock detection: with_for()/with_until() wait natively on a policy with try_lock_until()
+// (e.g. std::timed_mutex) or try_lock_shared_until() for shared reads; other policies are polled
+template <typename L, typename = void>
+struct is_timed_lockable : std::false_type {};
+template <typename L>
+struct is_timed_lockable<L, std::void_t<decltype(std::declval<L&>().try_lock_until(
+                                std::declval<const std::chrono::steady_clock::time_point&>()))>> : std::true_type {};
+template <typename L>
+inline constexpr bool is_timed_lockable_v = is_timed_lockable<L>::value;
+
+template <typename L, typename = void>
+struct is_shared_timed_lockable : std::false_type {};
+template <typename L>
+struct is_shared_timed_lockable<L, std::void_t<decltype(std::declval<L&>().try_lock_shared_until(
+                                       std::declval<const std::chrono::steady_clock::time_point&>()))>> : std::true_type {};
+template <typename L>
+inline constexpr bool is_shared_timed_lockable_v = is_shared_timed_lockable<L>::value;
+
+// test-and-test-and-set spinlock
+// - one byte of state, never sleeps in the kernel
+// - meant for the very short critical sections of MutexString (size(), empty(), operator==, ...)
+class SpinLock {
+public:
+    SpinLock() = default;
+    SpinLock(const SpinLock&) = delete;
+    SpinLock& operator=(const SpinLock&) = delete;
+
+    void lock() noexcept {
+        for (;;) {
+            if (!locked_.exchange(true, std::memory_order_acquire)) return;
+            // spin on a plain load so the cache line stays shared while the owner works
+            while (locked_.load(std::memory_order_relaxed)) detail::cpu_relax();
+        }
+    }
+    bool try_lock() noexcept {
+        return !locked_.load(std::memory_order_relaxed)
+            && !locked_.exchange(true, std::memory_order_acquire);
+    }
+    void unlock() noexcept { locked_.store(false, std::memory_order_release); }
+
+private:
+    std::atomic<bool> locked_{false};
+};
+
+// adaptive spin-then-park mutex
+// - 4 bytes of state: 0 = free, 1 = locked, 2 = locked with (possible) parked waiters
+// - contended lock() spins up to SpinBudget pause instructions with exponential backoff before parking,
+//   so the few-nanosecond critical sections of MutexString are usually handed over without a syscall
+// - unlock() only enters the kernel when a waiter is parked
+// - a larger SpinBudget suits more cores / shorter sections; 0 parks immediately (plain futex mutex)
+template <unsigned SpinBudget = 128>
+class BasicAdaptiveLock {
+public:
+    static constexpr unsigned spin_budget = SpinBudget;
+
+    BasicAdaptiveLock() = default;
+    BasicAdaptiveLock(const BasicAdaptiveLock&) = delete;
+    BasicAdaptiveLock& operator=(const BasicAdaptiveLock&) = delete;
+
+    void lock() noexcept {
+        std::uint32_t c = 0;
+        if (state_.compare_exchange_strong(c, 1, std::memory_order_acquire, std::memory_order_relaxed)) return;
+        lock_slow_();
+    }
+    bool try_lock() noexcept {
+        std::uint32_t c = 0;
+        return state_.compare_exchange_strong(c, 1, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+    void unlock() noexcept {
+        if (state_.exchange(0, std::memory_order_release) == 2) detail::futex_wake_one(&state_);
+    }
+
+private:
+    void lock_slow_() noexcept {
+        // 1) bounded spin with exponential pause backoff (skipped once somebody is parked)
+        unsigned pause = 1;
+        for (unsigned spent = 0; spent < SpinBudget; spent += pause) {
+            std::uint32_t c = state_.load(std::memory_order_relaxed);
+            if (c == 2) break;
+            if (c == 0 && state_.compare_exchange_weak(c, 1, std::memory_order_acquire, std::memory_order_relaxed)) return;
+            for (unsigned i = 0; i < pause; ++i) detail::cpu_relax();
+            if (pause < 32) pause <<= 1;
+        }
+        // 2) park: mark "waiters present" and sleep until the owner wakes us
+        while (state_.exchange(2, std::memory_order_acquire) != 0) detail::futex_wait(&state_, 2);
+    }
+
+    std::atomic<std::uint32_t> state_{0};
+};
+
+using AdaptiveLock = BasicAdaptiveLock<>;
+
+// one-byte parking-lot mutex (WebKit WTF::Lock style)
+// - bit 0 = locked, bit 1 = waiters may be parked; the wait queue lives in the global parking lot,
+//   so BasicMutexString<CompactLock> is a std::string plus one byte (+ padding)
+// - uncontended lock/unlock is one CAS / one exchange, like SpinLock
+// - contended lock() spins briefly, then parks; unlock() only calls into the parking lot when bit 1 is set
+// - waiters of unrelated locks that hash to the same parking word are woken too and simply re-park
+class CompactLock {
+public:
+    CompactLock() = default;
+    CompactLock(const CompactLock&) = delete;
+    CompactLock& operator=(const CompactLock&) = delete;
+
+    void lock() noexcept {
+        std::uint8_t c = 0;
+        if (state_.compare_exchange_weak(c, locked_bit, std::memory_order_acquire, std::memory_order_relaxed)) return;
+        lock_slow_();
+    }
+    bool try_lock() noexcept {
+        std::uint8_t c = state_.load(std::memory_order_relaxed);
+        while (!(c & locked_bit)) {
+            if (state_.compare_exchange_weak(c, c | locked_bit, std::memory_order_acquire, std::memory_order_relaxed)) return true;
+        }
+        return false;
+    }
+    void unlock() noexcept {
+        std::uint8_t c = locked_bit;
+        if (state_.compare_exchange_strong(c, 0, std::memory_order_release, std::memory_order_relaxed)) return;
+        unlock_slow_();
+    }
+
+private:
+    static constexpr std::uint8_t locked_bit = 1;
+    static constexpr std::uint8_t parked_bit = 2;
+
+    void lock_slow_() noexcept;     // LockPolicy.cpp
+    void unlock_slow_() noexcept;
+
+    std::atomic<std::uint8_t> state_{0};
+};
+
+// no-op lock
+// - for instances that are confined to one thread (or externally synchronized)
+// - keeps the MutexString API without paying for any atomic operation
+class NullLock {
+public:
+    void lock() noexcept {}
+    bool try_lock() noexcept { return true; }
+    void unlock() noexcept {}
+};
+
+} // namespace j2
@@ -0,0 +1,131 @@
+#include "LogBuffer.hpp"
+
+#include <cerrno>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace j2 {
+
+// ================= constructors =================
+LogBuffer::LogBuffer(std::size_t reserve) {
+    active_.reserve(reserve);
+    spare_.reserve(reserve);
+}
+
+LogBuffer::~LogBuffer() { stop_flusher(); }
+
+// ================= appends =================
+// only the append that crosses the flush threshold wakes the flusher; the others never touch the condition variable
+LogBuffer& LogBuffer::append(std::string_view s) {
+    bool wake;
+    {
+        std::scoped_lock lock(m_);
+        const std::size_t before = active_.size();
+        active_.append(s);
+        wake = crossed_(before);
+    }
+    if (wake) cv_.notify_one();
+    return *this;
+}
+
+LogBuffer& LogBuffer::append(std::size_t count, char ch) {
+    bool wake;
+    {
+        std::scoped_lock lock(m_);
+        const std::size_t before = active_.size();
+        active_.append(count, ch);
+        wake = crossed_(before);
+    }
+    if (wake) cv_.notify_one();
+    return *this;
+}
+
+bool LogBuffer::crossed_(std::size_t before) noexcept {
+    const std::size_t after = active_.size();
+    size_.store(after, std::memory_order_relaxed);
+    return threshold_ && before < threshold_ && after >= threshold_;
+}
+
+// ================= drain =================
+std::string LogBuffer::drain() {
+    std::string out;
+    std::scoped_lock lock(m_);
+    out.swap(active_);      // O(1): the full buffer changes owner
+    active_.swap(spare_);   // appends continue in the recycled one
+    size_.store(0, std::memory_order_relaxed);
+    return out;
+}
+
+void LogBuffer::recycle(std::string&& buf) {
+    buf.clear();
+    std::scoped_lock lock(m_);
+    if (buf.capacity() > spare_.capacity()) spare_.swap(buf);   // keep the larger block, free the other after unlocking
+}
+
+// ================= background flusher =================
+void LogBuffer::start_flusher(FlushOptions options) {
+    if (options.fd < 0) throw std::invalid_argument("LogBuffer::start_flusher: invalid file descriptor");
+    if (flusher_.joinable()) throw std::logic_error("LogBuffer::start_flusher: flusher already running");
+    {
+        std::scoped_lock lock(m_);
+        threshold_ = options.size_threshold ? options.size_threshold : 1;
+        stop_ = false;
+    }
+    flusher_ = std::thread([this, options] { flush_loop_(options); });
+    running_.store(true, std::memory_order_release);
+}
+
+void LogBuffer::stop_flusher() {
+    if (!flusher_.joinable()) return;
+    {
+        std::scoped_lock lock(m_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    flusher_.join();
+    running_.store(false, std::memory_order_release);
+    std::scoped_lock lock(m_);
+    threshold_ = 0;
+}
+
+void LogBuffer::flush_loop_(FlushOptions options) {
+    for (;;) {
+        bool last;
+        {
+            std::unique_lock lock(m_);
+            cv_.wait_for(lock, options.interval, [&] { return stop_ || active_.size() >= threshold_; });
+            last = stop_;
+        }
+        // drain and write without m_: appenders only wait for the O(1) flip
+        drain_to([&](std::string_view s) {
+            if (int err = write_all_(options.fd, s)) error_.store(err, std::memory_order_relaxed);
+            else flushed_.fetch_add(s.size(), std::memory_order_relaxed);
+        });
+        if (last) return;
+    }
+}
+
+int LogBuffer::write_all_(int fd, std::string_view s) noexcept {
+    while (!s.empty()) {
+#if defined(_WIN32)
+        const unsigned chunk = s.size() > 0x40000000u ? 0x40000000u : static_cast<unsigned>(s.size());
+        const int n = ::_write(fd, s.data(), chunk);
+#else
+        const ::ssize_t n = ::write(fd, s.data(), s.size());
+#endif
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return errno;
+        }
+        if (n == 0) return EIO;   // no progress and no error: retrying would spin forever
+        s.remove_prefix(static_cast<std::size_t>(n));
+    }
+    return 0;
+}
+
+} // namespace j2
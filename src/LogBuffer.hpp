@@ -0,0 +1,95 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// j2 namespace
+namespace j2 {
+
+// double-buffered append-only string for log accumulation (many appenders, one drainer)
+// - appends go to the active buffer under a short lock (one std::string append, no allocation once warm)
+// - drain() swaps the active buffer with the spare one in O(1) and hands the full one out without copying;
+//   giving it back with recycle() (drain_to() does it) keeps both buffers' capacity, so a steady log
+//   rate runs without reallocating
+// - start_flusher(): a background thread writes the drained buffer to a file descriptor once size_threshold
+//   bytes are pending or interval has passed since the last flush, outside the append lock
+class LogBuffer {
+public:
+    struct FlushOptions {
+        int fd = -1;                                      // not owned, stays open while the flusher runs
+        std::size_t size_threshold = 64 * 1024;           // flush as soon as this much is pending
+        std::chrono::milliseconds interval{100};          // ... or at the latest after this long
+    };
+
+    explicit LogBuffer(std::size_t reserve = 64 * 1024);   // capacity of each buffer up front
+    ~LogBuffer();                                          // stops the flusher (final flush included)
+    LogBuffer(const LogBuffer&) = delete;
+    LogBuffer& operator=(const LogBuffer&) = delete;
+
+    // ===== appends (any thread) =====
+    LogBuffer& append(std::string_view s);
+    LogBuffer& append(std::size_t count, char ch);
+    LogBuffer& operator+=(std::string_view s) { return append(s); }
+    LogBuffer& operator+=(const char* s) { return append(std::string_view(s ? s : "")); }
+    LogBuffer& operator+=(char ch) { return append(1, ch); }
+    void push_back(char ch) { append(1, ch); }
+
+    // bytes pending in the active buffer (lock-free, updated by every append)
+    std::size_t size() const noexcept { return size_.load(std::memory_order_relaxed); }
+    bool empty() const noexcept { return size() == 0; }
+
+    // ===== drain (one consumer at a time) =====
+    // the pending bytes, moved out in O(1); appends continue in the spare buffer meanwhile
+    std::string drain();
+    // give a drained buffer back: its capacity becomes the next spare (contents are discarded)
+    void recycle(std::string&& buf);
+    // drain, call fn(std::string_view) without any lock held, recycle; returns the number of bytes drained
+    template <typename Fn>
+    std::size_t drain_to(Fn&& fn) {
+        std::string buf = drain();
+        const std::size_t n = buf.size();
+        if (n) std::forward<Fn>(fn)(std::string_view(buf));
+        recycle(std::move(buf));
+        return n;
+    }
+
+    // ===== background flusher =====
+    // throws std::invalid_argument for a negative fd, std::logic_error if a flusher is already running
+    void start_flusher(FlushOptions options);
+    // flushes what is pending, then joins the thread (no-op without a flusher)
+    void stop_flusher();
+    bool flushing() const noexcept { return running_.load(std::memory_order_acquire); }
+
+    // flusher statistics: bytes written, and errno of the last failed write (0: none); a failed
+    // write drops that buffer (logging must not block appenders on a broken descriptor)
+    std::uint64_t bytes_flushed() const noexcept { return flushed_.load(std::memory_order_relaxed); }
+    int last_error() const noexcept { return error_.load(std::memory_order_relaxed); }
+
+private:
+    void flush_loop_(FlushOptions options);
+    bool crossed_(std::size_t before) noexcept;   // m_ held, after an append: update size_, true if the flusher should wake
+    static int write_all_(int fd, std::string_view s) noexcept;   // 0 or errno
+
+    mutable std::mutex m_;
+    std::string active_;                       // under m_
+    std::string spare_;                        // under m_: the empty buffer the next drain() switches to
+    std::atomic<std::size_t> size_{0};         // mirror of active_.size()
+
+    // flusher (state under m_)
+    std::condition_variable cv_;
+    std::thread flusher_;                      // started/joined by start_flusher()/stop_flusher() only
+    std::atomic<bool> running_{false};         // flushing(): readable from any thread, unlike flusher_
+    std::size_t threshold_ = 0;                // 0: no flusher (appends never notify)
+    bool stop_ = false;
+    std::atomic<std::uint64_t> flushed_{0};
+    std::atomic<int> error_{0};
+};
+
+} // namespace j2
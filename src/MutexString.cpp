@@ -1,562 +1,1228 @@
 #include "MutexString.hpp"
+#include "StringSearch.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <thread>
 
 namespace j2 {
 
 #ifndef NDEBUG
-thread_local const MutexString* MutexString::tls_owner_ = nullptr;
+thread_local const void* detail::MutexStringBase::tls_owner_ = nullptr;
 #endif
 
+// shard of the calling thread for feature::sharded_append (round-robin on first use)
+unsigned detail::this_thread_shard() noexcept {
+    static std::atomic<unsigned> next{0};
+    thread_local unsigned index = ~0u;   // constant-initialized: no TLS init guard on the append path
+    if (index == ~0u) index = next.fetch_add(1, std::memory_order_relaxed) % static_cast<unsigned>(kAppendShards);
+    return index;
+}
+
+// process-wide memory totals (feature::memory_stats), one cache line per shard
+namespace {
+struct alignas(detail::kCacheLine) MemoryCounterShard {
+    std::atomic<std::ptrdiff_t> instances{0}, size{0}, capacity{0}, heap{0};
+    std::atomic<std::size_t> reallocations{0};
+};
+MemoryCounterShard g_memory[detail::kAppendShards];
+} // namespace
+
+void detail::account_memory(std::ptrdiff_t instances, std::ptrdiff_t size, std::ptrdiff_t capacity,
+                            std::ptrdiff_t heap, std::size_t reallocations) noexcept {
+    MemoryCounterShard& sh = g_memory[this_thread_shard()];
+    if (instances) sh.instances.fetch_add(instances, std::memory_order_relaxed);
+    if (size) sh.size.fetch_add(size, std::memory_order_relaxed);
+    if (capacity) sh.capacity.fetch_add(capacity, std::memory_order_relaxed);
+    if (heap) sh.heap.fetch_add(heap, std::memory_order_relaxed);
+    if (reallocations) sh.reallocations.fetch_add(reallocations, std::memory_order_relaxed);
+}
+
+MemoryTotals memory_totals() noexcept {
+    // shards hold signed deltas (an object may grow on one thread and die on another): sum, then convert
+    std::ptrdiff_t instances = 0, size = 0, capacity = 0, heap = 0;
+    MemoryTotals t;
+    for (const MemoryCounterShard& sh : g_memory) {
+        instances += sh.instances.load(std::memory_order_relaxed);
+        size += sh.size.load(std::memory_order_relaxed);
+        capacity += sh.capacity.load(std::memory_order_relaxed);
+        heap += sh.heap.load(std::memory_order_relaxed);
+        t.reallocations += sh.reallocations.load(std::memory_order_relaxed);
+    }
+    t.instances = static_cast<std::size_t>(std::max<std::ptrdiff_t>(instances, 0));
+    t.size = static_cast<std::size_t>(std::max<std::ptrdiff_t>(size, 0));
+    t.capacity = static_cast<std::size_t>(std::max<std::ptrdiff_t>(capacity, t.size));
+    t.heap_bytes = static_cast<std::size_t>(std::max<std::ptrdiff_t>(heap, 0));
+    return t;
+}
+
 // ================= Locked implementation =================
-MutexString::Locked::Locked(std::string& s, std::mutex& m, const MutexString* owner)
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>::Locked::Locked(string_type& s, LockPolicy& m, const BasicMutexString* owner)
     : s_(&s)
     , lock_(m)                 // ✅ initialize lock_ before owner_
-#ifndef NDEBUG
     , owner_(owner)
-#endif
 {
+    owner_->merge_();
+    owner_->detach_();         // the guard hands out s_ for writing
 #ifndef NDEBUG
     // set mark to block calling other members of the same object during guard lifetime
-    assert(MutexString::tls_owner_ != owner_ && "no reentrancy on same object (calling ms.* while guard is held)");
-    MutexString::tls_owner_ = owner_;
+    assert(BasicMutexString::tls_owner_ != owner_ && "no reentrancy on same object (calling ms.* while guard is held)");
+    BasicMutexString::tls_owner_ = owner_;
     mark_set_ = true;
 #endif
 }
 
-MutexString::Locked::Locked(const std::string& s, std::mutex& m, const MutexString* owner)
-    : cs_(&s)
-    , lock_(m)                 // ✅ initialize lock_ before owner_
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>::Locked::Locked(const string_type& s, LockPolicy& m, const BasicMutexString* owner)
+    : rlock_(m)                // ✅ read-only guard: shared ownership when LockPolicy supports it
+    , owner_(owner)
+{
+    (void)s;
+    owner_->merge_();   // exclusive with sharded appends (see shared_reads)
+    cs_ = &owner_->cur_();     // read under the lock: the value may live in a shared snapshot buffer
 #ifndef NDEBUG
+    assert(BasicMutexString::tls_owner_ != owner_ && "no reentrancy on same object (calling ms.* while guard is held)");
+    BasicMutexString::tls_owner_ = owner_;
+    mark_set_ = true;
+#endif
+}
+
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>::Locked::Locked(string_type& s, LockPolicy& m, const BasicMutexString* owner,
+                                                       std::try_to_lock_t)
+    : lock_(m, std::try_to_lock)
     , owner_(owner)
+{
+    if (!lock_.owns_lock()) return;   // empty guard: s_ stays null, nothing to release
+    s_ = &s;
+    owner_->merge_();
+    owner_->detach_();
+#ifndef NDEBUG
+    assert(BasicMutexString::tls_owner_ != owner_ && "no reentrancy on same object (calling ms.* while guard is held)");
+    BasicMutexString::tls_owner_ = owner_;
+    mark_set_ = true;
 #endif
+}
+
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>::Locked::Locked(const string_type& s, LockPolicy& m, const BasicMutexString* owner,
+                                                       std::try_to_lock_t)
+    : rlock_(m, std::try_to_lock)
+    , owner_(owner)
 {
+    if (!rlock_.owns_lock()) return;
+    (void)s;
+    owner_->merge_();
+    cs_ = &owner_->cur_();
 #ifndef NDEBUG
-    assert(MutexString::tls_owner_ != owner_ && "no reentrancy on same object (calling ms.* while guard is held)");
-    MutexString::tls_owner_ = owner_;
+    assert(BasicMutexString::tls_owner_ != owner_ && "no reentrancy on same object (calling ms.* while guard is held)");
+    BasicMutexString::tls_owner_ = owner_;
     mark_set_ = true;
 #endif
 }
 
-MutexString::Locked::~Locked() {
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>::Locked::~Locked() {
+    // a mutable guard may have changed the string: publish before lock_ is released
+    if (lock_.owns_lock()) owner_->commit_();
 #ifndef NDEBUG
-    if (mark_set_ && MutexString::tls_owner_ == owner_) {
-        MutexString::tls_owner_ = nullptr;
+    if (mark_set_ && BasicMutexString::tls_owner_ == owner_) {
+        BasicMutexString::tls_owner_ = nullptr;
     }
 #endif
 }
 
-std::string* MutexString::Locked::operator->() { return s_; }
-const std::string* MutexString::Locked::operator->() const { return cs_ ? cs_ : s_; }
-std::string& MutexString::Locked::operator*() { return *s_; }
-const std::string& MutexString::Locked::operator*() const { return cs_ ? *cs_ : *s_; }
+template <typename LockPolicy, unsigned Features>
+typename BasicMutexString<LockPolicy, Features>::string_type* BasicMutexString<LockPolicy, Features>::Locked::operator->() { return s_; }
+template <typename LockPolicy, unsigned Features>
+const typename BasicMutexString<LockPolicy, Features>::string_type* BasicMutexString<LockPolicy, Features>::Locked::operator->() const { return cs_ ? cs_ : s_; }
+template <typename LockPolicy, unsigned Features>
+typename BasicMutexString<LockPolicy, Features>::string_type& BasicMutexString<LockPolicy, Features>::Locked::operator*() { return *s_; }
+template <typename LockPolicy, unsigned Features>
+const typename BasicMutexString<LockPolicy, Features>::string_type& BasicMutexString<LockPolicy, Features>::Locked::operator*() const { return cs_ ? *cs_ : *s_; }
 
-void MutexString::Locked::unlock() {
-    lock_.unlock();
+template <typename LockPolicy, unsigned Features>
+void BasicMutexString<LockPolicy, Features>::Locked::unlock() {
+    if (lock_.owns_lock()) {
+        owner_->commit_();
+        lock_.unlock();
+    }
+    if (rlock_.owns_lock()) rlock_.unlock();
 #ifndef NDEBUG
     // if guard is released early, the owner mark is no longer kept
-    if (mark_set_ && MutexString::tls_owner_ == owner_) {
-        MutexString::tls_owner_ = nullptr;
+    if (mark_set_ && BasicMutexString::tls_owner_ == owner_) {
+        BasicMutexString::tls_owner_ = nullptr;
         mark_set_ = false;
     }
 #endif
 }
-bool MutexString::Locked::owns_lock() const { return lock_.owns_lock(); }
+template <typename LockPolicy, unsigned Features>
+bool BasicMutexString<LockPolicy, Features>::Locked::owns_lock() const { return lock_.owns_lock() || rlock_.owns_lock(); }
 
 // protected method: only safe during guard lifetime
-const char* MutexString::Locked::guard_cstr() const {
+template <typename LockPolicy, unsigned Features>
+const char* BasicMutexString<LockPolicy, Features>::Locked::guard_cstr() const {
     return (cs_ ? cs_ : s_)->c_str();
 }
 
 // ================= CStrGuard implementation =================
-MutexString::CStrGuard::CStrGuard(const std::string& s, std::mutex& m)
-    : lock_(m), p_(s.c_str()) {
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>::CStrGuard::CStrGuard(const string_type& s, LockPolicy& m,
+                                                            const BasicMutexString* owner)
+    : lock_(m) {
+    (void)s;
+    owner->merge_();
+    p_ = owner->cur_().c_str();
     // NOTE: p_ is the internal buffer pointer of std::string,
     // it can only be used safely during the CStrGuard lifetime (=while lock is held).
 }
 
 // ================= MutexString core =================
-MutexString::MutexString(std::string s) : s_(std::move(s)) {}
-MutexString::MutexString(const char* s) : s_(s ? s : "") {}
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>::BasicMutexString() { commit_(); }
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>::BasicMutexString(std::string s) : s_(std::move(s)) { commit_(); }
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>::BasicMutexString(const char* s) : s_(s ? s : "") { commit_(); }
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>::BasicMutexString(Interned v) { adopt_(v); commit_(); }
 
-MutexString::MutexString(const MutexString& other) {
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>::BasicMutexString(const BasicMutexString& other) {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(other.m_);
-    s_ = other.s_;
+    read_lock_type lock(other.m_);
+    other.merge_();
+    s_ = other.cur_();
+    commit_();
 }
-MutexString::MutexString(MutexString&& other) noexcept {
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>::BasicMutexString(BasicMutexString&& other) noexcept {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
     std::scoped_lock lock(other.m_);
-    s_ = std::move(other.s_);
+    other.merge_();
+    adopt_buffer_(other);
+    commit_();
+    other.commit_();
 }
 
-MutexString& MutexString::operator=(const MutexString& other) {
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>& BasicMutexString<LockPolicy, Features>::operator=(const BasicMutexString& other) {
     if (this != &other) {
 #ifndef NDEBUG
         assert_not_reentrant_();
 #endif
-        std::scoped_lock lock(m_, other.m_);
-        s_ = other.s_;
+        // exclusive on this, read (shared when available) on other; std::lock avoids lock-order deadlock
+        std::unique_lock<LockPolicy> wlock(m_, std::defer_lock);
+        read_lock_type rlock(other.m_, std::defer_lock);
+        std::lock(wlock, rlock);
+        merge_();   // pending appends of this object are overwritten, but must not resurface later
+        discard_();
+        other.merge_();
+        s_ = other.cur_();
+        commit_();
     }
     return *this;
 }
 
-MutexString& MutexString::operator=(MutexString&& other) noexcept {
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>& BasicMutexString<LockPolicy, Features>::operator=(BasicMutexString&& other) noexcept {
     if (this != &other) {
 #ifndef NDEBUG
         assert_not_reentrant_();
 #endif
         std::scoped_lock lock(m_, other.m_);
-        s_ = std::move(other.s_);
+        merge_();
+        discard_();
+        other.merge_();
+        adopt_buffer_(other);
+        commit_();
+        other.commit_();
     }
     return *this;
 }
 
 // ===== std::string/char* assignment =====
-MutexString& MutexString::operator=(const std::string& rhs) {
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>& BasicMutexString<LockPolicy, Features>::operator=(const std::string& rhs) {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_);
+    std::scoped_lock lock(m_); merge_(); discard_();
     s_ = rhs;
+    commit_();
     return *this;
 }
-MutexString& MutexString::operator=(const char* rhs) {
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>& BasicMutexString<LockPolicy, Features>::operator=(const char* rhs) {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_);
+    std::scoped_lock lock(m_); merge_(); discard_();
     s_ = (rhs ? rhs : "");
+    commit_();
     return *this;
 }
 
 // ===== comparison =====
-bool MutexString::operator==(const std::string& rhs) const {
+template <typename LockPolicy, unsigned Features>
+bool BasicMutexString<LockPolicy, Features>::operator==(const std::string& rhs) const {
+#ifndef NDEBUG
+    assert_not_reentrant_();
+#endif
+    read_lock_type lock(m_); merge_();
+    return std::string_view(cur_()) == rhs;
+}
+template <typename LockPolicy, unsigned Features>
+bool BasicMutexString<LockPolicy, Features>::operator==(const char* rhs) const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_);
-    return s_ == rhs;
+    read_lock_type lock(m_); merge_();
+    return cur_() == (rhs ? rhs : "");
 }
-bool MutexString::operator==(const char* rhs) const {
+template <typename LockPolicy, unsigned Features>
+bool BasicMutexString<LockPolicy, Features>::operator==(const Interned& v) const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_);
-    return s_ == (rhs ? rhs : "");
+    read_lock_type lock(m_); merge_();
+    if constexpr (cow_snapshots) {
+        if (this->pooled_ && this->pooled_ == v.get()) return true;   // still the pool entry
+    }
+    return std::string_view(cur_()) == v.view();
 }
 
 // ===== capacity/status =====
-std::size_t MutexString::size() const {
+template <typename LockPolicy, unsigned Features>
+std::size_t BasicMutexString<LockPolicy, Features>::size() const {
+#ifndef NDEBUG
+    assert_not_reentrant_();
+#endif
+    if constexpr (mirrors_size) return this->size_.load(std::memory_order_acquire);
+    read_lock_type lock(m_); merge_(); return cur_().size();
+}
+template <typename LockPolicy, unsigned Features>
+std::size_t BasicMutexString<LockPolicy, Features>::length() const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.size();
+    if constexpr (mirrors_size) return this->size_.load(std::memory_order_acquire);
+    read_lock_type lock(m_); merge_(); return cur_().length();
 }
-std::size_t MutexString::length() const {
+template <typename LockPolicy, unsigned Features>
+bool BasicMutexString<LockPolicy, Features>::empty() const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.length();
+    if constexpr (mirrors_size) return this->size_.load(std::memory_order_acquire) == 0;
+    read_lock_type lock(m_); merge_(); return cur_().empty();
 }
-bool MutexString::empty() const {
+template <typename LockPolicy, unsigned Features>
+std::size_t BasicMutexString<LockPolicy, Features>::capacity() const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.empty();
+    if constexpr (mirrors_size) return this->capacity_.load(std::memory_order_acquire);
+    read_lock_type lock(m_); merge_(); return cur_().capacity();
 }
-std::size_t MutexString::capacity() const {
+template <typename LockPolicy, unsigned Features>
+std::size_t BasicMutexString<LockPolicy, Features>::max_size() const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.capacity();
+    read_lock_type lock(m_); return s_.max_size();
 }
-std::size_t MutexString::max_size() const {
+template <typename LockPolicy, unsigned Features>
+void BasicMutexString<LockPolicy, Features>::reserve(std::size_t n) {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.max_size();
+    std::scoped_lock lock(m_); merge_(); detach_(); s_.reserve(n); commit_();
 }
-void MutexString::reserve(std::size_t n) {
+template <typename LockPolicy, unsigned Features>
+void BasicMutexString<LockPolicy, Features>::shrink_to_fit() {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); s_.reserve(n);
+    std::scoped_lock lock(m_); merge_(); detach_(); s_.shrink_to_fit(); commit_();
 }
-void MutexString::shrink_to_fit() {
+
+template <typename LockPolicy, unsigned Features>
+MemoryUsage BasicMutexString<LockPolicy, Features>::memory_usage() const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); s_.shrink_to_fit();
+    read_lock_type lock(m_); merge_();
+    const string_type& v = cur_();
+    MemoryUsage u;
+    u.size = v.size();
+    u.capacity = v.capacity();
+    u.heap_bytes = heap_bytes_(v);
+    if constexpr (accounts_memory) u.reallocations = this->acct_reallocs_;
+    return u;
 }
 
 // ===== element access (value return) + setter =====
-char MutexString::at(std::size_t pos) const {
+template <typename LockPolicy, unsigned Features>
+char BasicMutexString<LockPolicy, Features>::at(std::size_t pos) const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.at(pos);
+    read_lock_type lock(m_); merge_(); return cur_().at(pos);
 }
-char MutexString::operator[](std::size_t pos) const {
+template <typename LockPolicy, unsigned Features>
+char BasicMutexString<LockPolicy, Features>::operator[](std::size_t pos) const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_[pos];
+    read_lock_type lock(m_); merge_(); return cur_()[pos];
 }
-char MutexString::front() const {
+template <typename LockPolicy, unsigned Features>
+char BasicMutexString<LockPolicy, Features>::front() const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.front();
+    read_lock_type lock(m_); merge_(); return cur_().front();
 }
-char MutexString::back() const {
+template <typename LockPolicy, unsigned Features>
+char BasicMutexString<LockPolicy, Features>::back() const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.back();
+    read_lock_type lock(m_); merge_(); return cur_().back();
 }
-void MutexString::set(std::size_t pos, char ch) {
+template <typename LockPolicy, unsigned Features>
+void BasicMutexString<LockPolicy, Features>::set(std::size_t pos, char ch) {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); s_.at(pos) = ch;
+    std::scoped_lock lock(m_); merge_(); detach_(); s_.at(pos) = ch; commit_();
 }
-void MutexString::front(char ch) {
+template <typename LockPolicy, unsigned Features>
+void BasicMutexString<LockPolicy, Features>::front(char ch) {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); s_.front() = ch;
+    std::scoped_lock lock(m_); merge_(); detach_(); s_.front() = ch; commit_();
 }
-void MutexString::back(char ch) {
+template <typename LockPolicy, unsigned Features>
+void BasicMutexString<LockPolicy, Features>::back(char ch) {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); s_.back() = ch;
+    std::scoped_lock lock(m_); merge_(); detach_(); s_.back() = ch; commit_();
 }
 
 // ===== modifiers =====
-void MutexString::clear() {
+template <typename LockPolicy, unsigned Features>
+void BasicMutexString<LockPolicy, Features>::clear() {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); s_.clear();
+    std::scoped_lock lock(m_); merge_(); discard_(); s_.clear(); commit_();
 }
-void MutexString::push_back(char ch) {
+template <typename LockPolicy, unsigned Features>
+void BasicMutexString<LockPolicy, Features>::push_back(char ch) {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); s_.push_back(ch);
+    if constexpr (shards_appends) { shard_append_(1, ch); return; }
+    if constexpr (combines_appends) { combine_append_(1, ch); return; }
+    std::scoped_lock lock(m_); merge_(); detach_(); s_.push_back(ch); commit_();
 }
-void MutexString::pop_back() {
+template <typename LockPolicy, unsigned Features>
+void BasicMutexString<LockPolicy, Features>::pop_back() {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); s_.pop_back();
+    std::scoped_lock lock(m_); merge_(); detach_(); s_.pop_back(); commit_();
 }
 
-void MutexString::assign(const std::string& s) {
+template <typename LockPolicy, unsigned Features>
+void BasicMutexString<LockPolicy, Features>::assign(const std::string& s) {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); s_ = s;
+    std::scoped_lock lock(m_); merge_(); discard_(); s_ = s; commit_();
 }
-void MutexString::assign(const char* s) {
+template <typename LockPolicy, unsigned Features>
+void BasicMutexString<LockPolicy, Features>::assign(const char* s) {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); s_ = (s ? s : "");
+    std::scoped_lock lock(m_); merge_(); discard_(); s_ = (s ? s : ""); commit_();
 }
-void MutexString::assign(std::size_t count, char ch) {
+template <typename LockPolicy, unsigned Features>
+void BasicMutexString<LockPolicy, Features>::assign(std::size_t count, char ch) {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); s_.assign(count, ch);
+    std::scoped_lock lock(m_); merge_(); discard_(); s_.assign(count, ch); commit_();
+}
+template <typename LockPolicy, unsigned Features>
+void BasicMutexString<LockPolicy, Features>::assign(Interned v) {
+#ifndef NDEBUG
+    assert_not_reentrant_();
+#endif
+    std::scoped_lock lock(m_); merge_(); adopt_(v); commit_();
 }
 
-MutexString& MutexString::append(const std::string& s) {
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>& BasicMutexString<LockPolicy, Features>::append(const std::string& s) {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); s_.append(s); return *this;
+    if constexpr (shards_appends) { shard_append_(s); return *this; }
+    if constexpr (combines_appends) { combine_append_(s); return *this; }
+    std::scoped_lock lock(m_); merge_(); detach_(); s_.append(s); commit_(); return *this;
 }
-MutexString& MutexString::append(const char* s) {
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>& BasicMutexString<LockPolicy, Features>::append(const char* s) {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); s_.append(s ? s : ""); return *this;
+    if constexpr (shards_appends) { shard_append_(s ? s : ""); return *this; }
+    if constexpr (combines_appends) { combine_append_(s ? s : ""); return *this; }
+    std::scoped_lock lock(m_); merge_(); detach_(); s_.append(s ? s : ""); commit_(); return *this;
 }
-MutexString& MutexString::append(std::size_t count, char ch) {
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>& BasicMutexString<LockPolicy, Features>::append(std::size_t count, char ch) {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); s_.append(count, ch); return *this;
+    if constexpr (shards_appends) { shard_append_(count, ch); return *this; }
+    if constexpr (combines_appends) { combine_append_(count, ch); return *this; }
+    std::scoped_lock lock(m_); merge_(); detach_(); s_.append(count, ch); commit_(); return *this;
 }
 
-MutexString& MutexString::operator+=(const std::string& s) {
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>& BasicMutexString<LockPolicy, Features>::operator+=(const std::string& s) {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); s_ += s; return *this;
+    if constexpr (shards_appends) { shard_append_(s); return *this; }
+    if constexpr (combines_appends) { combine_append_(s); return *this; }
+    std::scoped_lock lock(m_); merge_(); detach_(); s_ += s; commit_(); return *this;
 }
-MutexString& MutexString::operator+=(const char* s) {
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>& BasicMutexString<LockPolicy, Features>::operator+=(const char* s) {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); s_ += (s ? s : ""); return *this;
+    if constexpr (shards_appends) { shard_append_(s ? s : ""); return *this; }
+    if constexpr (combines_appends) { combine_append_(s ? s : ""); return *this; }
+    std::scoped_lock lock(m_); merge_(); detach_(); s_ += (s ? s : ""); commit_(); return *this;
 }
-MutexString& MutexString::operator+=(char ch) {
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>& BasicMutexString<LockPolicy, Features>::operator+=(char ch) {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); s_ += ch; return *this;
+    if constexpr (shards_appends) { shard_append_(1, ch); return *this; }
+    if constexpr (combines_appends) { combine_append_(1, ch); return *this; }
+    std::scoped_lock lock(m_); merge_(); detach_(); s_ += ch; commit_(); return *this;
 }
 
-MutexString& MutexString::insert(std::size_t pos, const std::string& s) {
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>& BasicMutexString<LockPolicy, Features>::insert(std::size_t pos, const std::string& s) {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); s_.insert(pos, s); return *this;
+    std::scoped_lock lock(m_); merge_(); detach_(); s_.insert(pos, s); commit_(); return *this;
 }
-MutexString& MutexString::insert(std::size_t pos, const char* s) {
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>& BasicMutexString<LockPolicy, Features>::insert(std::size_t pos, const char* s) {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); s_.insert(pos, s ? s : ""); return *this;
+    std::scoped_lock lock(m_); merge_(); detach_(); s_.insert(pos, s ? s : ""); commit_(); return *this;
 }
-MutexString& MutexString::insert(std::size_t pos, std::size_t count, char ch) {
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>& BasicMutexString<LockPolicy, Features>::insert(std::size_t pos, std::size_t count, char ch) {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); s_.insert(pos, count, ch); return *this;
+    std::scoped_lock lock(m_); merge_(); detach_(); s_.insert(pos, count, ch); commit_(); return *this;
 }
 
-MutexString& MutexString::erase(std::size_t pos, std::size_t count) {
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>& BasicMutexString<LockPolicy, Features>::erase(std::size_t pos, std::size_t count) {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); s_.erase(pos, count); return *this;
+    std::scoped_lock lock(m_); merge_(); detach_(); s_.erase(pos, count); commit_(); return *this;
 }
 
-MutexString& MutexString::replace(std::size_t pos, std::size_t count, const std::string& s) {
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>& BasicMutexString<LockPolicy, Features>::replace(std::size_t pos, std::size_t count, const std::string& s) {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); s_.replace(pos, count, s); return *this;
+    std::scoped_lock lock(m_); merge_(); detach_(); s_.replace(pos, count, s); commit_(); return *this;
 }
-MutexString& MutexString::replace(std::size_t pos, std::size_t count, const char* s) {
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>& BasicMutexString<LockPolicy, Features>::replace(std::size_t pos, std::size_t count, const char* s) {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); s_.replace(pos, count, s ? s : ""); return *this;
+    std::scoped_lock lock(m_); merge_(); detach_(); s_.replace(pos, count, s ? s : ""); commit_(); return *this;
 }
-MutexString& MutexString::replace(std::size_t pos, std::size_t count, std::size_t n, char ch) {
+template <typename LockPolicy, unsigned Features>
+BasicMutexString<LockPolicy, Features>& BasicMutexString<LockPolicy, Features>::replace(std::size_t pos, std::size_t count, std::size_t n, char ch) {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); s_.replace(pos, count, n, ch); return *this;
+    std::scoped_lock lock(m_); merge_(); detach_(); s_.replace(pos, count, n, ch); commit_(); return *this;
 }
 
-void MutexString::resize(std::size_t n) {
+template <typename LockPolicy, unsigned Features>
+void BasicMutexString<LockPolicy, Features>::resize(std::size_t n) {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); s_.resize(n);
+    std::scoped_lock lock(m_); merge_(); detach_(); s_.resize(n); commit_();
 }
-void MutexString::resize(std::size_t n, char ch) {
+template <typename LockPolicy, unsigned Features>
+void BasicMutexString<LockPolicy, Features>::resize(std::size_t n, char ch) {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); s_.resize(n, ch);
+    std::scoped_lock lock(m_); merge_(); detach_(); s_.resize(n, ch); commit_();
 }
 
-void MutexString::swap(MutexString& other) {
+template <typename LockPolicy, unsigned Features>
+void BasicMutexString<LockPolicy, Features>::swap(BasicMutexString& other) {
     if (this == &other) return;
 #ifndef NDEBUG
     assert_not_reentrant_();
     other.assert_not_reentrant_();
 #endif
-    MutexString* first  = this < &other ? this : &other;
-    MutexString* second = this < &other ? &other : this;
+    BasicMutexString* first  = this < &other ? this : &other;
+    BasicMutexString* second = this < &other ? &other : this;
     std::scoped_lock lock(first->m_, second->m_);
-    s_.swap(other.s_);
+    merge_();
+    other.merge_();
+    if constexpr (uses_pmr) {
+        // each value stays on its own resource: swapping buffers of different resources would mix them up
+        if (s_.get_allocator() != other.s_.get_allocator()) {
+            string_type mine(other.s_, s_.get_allocator());
+            string_type theirs(s_, other.s_.get_allocator());
+            s_.swap(mine);
+            other.s_.swap(theirs);
+        } else {
+            s_.swap(other.s_);
+        }
+    } else {
+        s_.swap(other.s_);
+    }
+    if constexpr (cow_snapshots) {
+        // shared buffers and pool entries change owner too
+        this->snap_.swap(other.snap_);
+        std::swap(this->pooled_, other.pooled_);
+    }
+    commit_();
+    other.commit_();
 }
-void MutexString::swap(std::string& other_str) {
+template <typename LockPolicy, unsigned Features>
+void BasicMutexString<LockPolicy, Features>::swap(std::string& other_str) {
 #ifndef NDEBUG
     assert_not_reentrant_(); // if the other std::string is shared, separate sync is required
 #endif
-    std::scoped_lock lock(m_); s_.swap(other_str);
+    std::scoped_lock lock(m_); merge_(); detach_();
+    if constexpr (uses_pmr) {
+        std::string prev(s_);   // different allocators: exchange by copy
+        s_.assign(other_str);
+        other_str.swap(prev);
+    } else {
+        s_.swap(other_str);
+    }
+    commit_();
+}
+
+// ===== flat-combining appends (feature::combining_append) =====
+template <typename LockPolicy, unsigned Features>
+void BasicMutexString<LockPolicy, Features>::combine_append_(std::string_view s) {
+    // uncontended: append directly, then serve whoever queued meanwhile
+    if (m_.try_lock()) {
+        std::unique_lock<LockPolicy> lock(m_, std::adopt_lock);
+        CommitOnExit _commit{this};
+        detach_();
+        s_.append(s);
+        drain_appends_();
+        return;
+    }
+    detail::AppendRequest req;
+    req.text = s;
+    combine_(req);
+}
+template <typename LockPolicy, unsigned Features>
+void BasicMutexString<LockPolicy, Features>::combine_append_(std::size_t count, char ch) {
+    if (m_.try_lock()) {
+        std::unique_lock<LockPolicy> lock(m_, std::adopt_lock);
+        CommitOnExit _commit{this};
+        detach_();
+        s_.append(count, ch);
+        drain_appends_();
+        return;
+    }
+    detail::AppendRequest req;
+    req.fill = count;
+    req.ch = ch;
+    combine_(req);
+}
+
+template <typename LockPolicy, unsigned Features>
+void BasicMutexString<LockPolicy, Features>::combine_(detail::AppendRequest& req) {
+    if constexpr (combines_appends) {
+        // 1) the lock was busy: publish the request (it lives on this stack frame until done)
+        auto& head = this->pending_;
+        req.next = head.load(std::memory_order_relaxed);
+        while (!head.compare_exchange_weak(req.next, &req, std::memory_order_release, std::memory_order_relaxed)) {}
+
+        // 2) wait until a combiner applied it, or take the lock and combine ourselves
+        for (unsigned spin = 0;; ++spin) {
+            std::uint32_t st = req.state.load(std::memory_order_acquire);
+            if (st == detail::AppendRequest::kDone) break;
+            if (m_.try_lock()) {
+                std::unique_lock<LockPolicy> lock(m_, std::adopt_lock);
+                CommitOnExit _commit{this};
+                detach_();
+                drain_appends_();   // our request is still queued unless another combiner finished it
+                break;
+            }
+            if (spin < 64) {
+                detail::cpu_relax();
+            } else if (spin < 72) {
+                std::this_thread::yield();
+            } else {
+                // park instead of polling the lock: the combiner that applies the request wakes us; the timeout
+                // covers a lock released by a holder that does not combine (reader, guard) with requests queued
+                if (st == detail::AppendRequest::kQueued
+                    && !req.state.compare_exchange_strong(st, detail::AppendRequest::kParked, std::memory_order_acquire)) {
+                    continue;   // completed meanwhile
+                }
+                detail::futex_wait_for(&req.state, detail::AppendRequest::kParked, std::chrono::microseconds(200));
+            }
+        }
+        if (req.error) std::rethrow_exception(req.error);
+    }
+}
+
+// lock held: apply queued requests in arrival order
+template <typename LockPolicy, unsigned Features>
+void BasicMutexString<LockPolicy, Features>::drain_appends_() {
+    if constexpr (combines_appends) {
+        // bounded: a steady stream of appenders must not keep one thread combining forever
+        for (int round = 0; round < 4; ++round) {
+            if (!this->pending_.load(std::memory_order_relaxed)) return;   // common case: no RMW
+            detail::AppendRequest* lifo = this->pending_.exchange(nullptr, std::memory_order_acquire);
+            detail::AppendRequest* fifo = nullptr;
+            while (lifo) {
+                detail::AppendRequest* next = lifo->next;
+                lifo->next = fifo;
+                fifo = lifo;
+                lifo = next;
+            }
+            while (fifo) {
+                detail::AppendRequest* next = fifo->next;   // read before done: the owner may return right after
+                try {
+                    fifo->apply(s_);
+                    bump_version_();   // one version per request, visible before its owner returns
+                } catch (...) {
+                    fifo->error = std::current_exception();  // rethrown by the thread that asked
+                }
+                // the owner may return as soon as it sees kDone: waking a word it already left is harmless,
+                // address-based waits never touch the memory on the waking side
+                if (fifo->state.exchange(detail::AppendRequest::kDone, std::memory_order_release) == detail::AppendRequest::kParked) {
+                    detail::futex_wake_one(&fifo->state);
+                }
+                fifo = next;
+            }
+        }
+    }
+}
+
+// ===== sharded appends (feature::sharded_append) =====
+template <typename LockPolicy, unsigned Features>
+detail::AppendShard* BasicMutexString<LockPolicy, Features>::this_shard_() {
+    if constexpr (shards_appends) {
+        detail::AppendShardSet* set = this->shards_.load(std::memory_order_acquire);
+        if (!set) {
+            auto* fresh = new detail::AppendShardSet;
+            if (this->shards_.compare_exchange_strong(set, fresh, std::memory_order_acq_rel)) set = fresh;
+            else delete fresh;   // another thread installed one first (set now points to it)
+        }
+        return &set->shard[detail::this_thread_shard()];
+    } else {
+        return nullptr;
+    }
+}
+template <typename LockPolicy, unsigned Features>
+void BasicMutexString<LockPolicy, Features>::shard_append_(std::string_view s) {
+    if constexpr (shards_appends) {   // instantiated for every policy, only reachable when enabled
+        detail::AppendShard& sh = *this_shard_();
+        {
+            std::scoped_lock lock(sh.lock);
+            sh.buf.append(s);
+            sh.pending.store(true, std::memory_order_release);
+        }
+        bump_version_();   // no commit_() on this path
+    }
+}
+template <typename LockPolicy, unsigned Features>
+void BasicMutexString<LockPolicy, Features>::shard_append_(std::size_t count, char ch) {
+    if constexpr (shards_appends) {
+        detail::AppendShard& sh = *this_shard_();
+        {
+            std::scoped_lock lock(sh.lock);
+            sh.buf.append(count, ch);   // straight into the shard: no temporary string
+            sh.pending.store(true, std::memory_order_release);
+        }
+        bump_version_();
+    }
+}
+
+// object lock held exclusively: move pending shard contents to s_ in shard order
+// (const: the value does not change, only where its tail is stored)
+template <typename LockPolicy, unsigned Features>
+void BasicMutexString<LockPolicy, Features>::merge_() const {
+    if constexpr (shards_appends) {
+        detail::AppendShardSet* set = this->shards_.load(std::memory_order_acquire);
+        if (!set) return;
+        for (detail::AppendShard& sh : set->shard) {
+            if (!sh.pending.load(std::memory_order_acquire)) continue;
+            detach_();
+            std::scoped_lock lock(sh.lock);
+            s_.append(sh.buf);
+            sh.buf.clear();   // keeps capacity for the next appends of that thread
+            sh.pending.store(false, std::memory_order_relaxed);
+        }
+    }
 }
 
 // ===== string operations =====
-std::string MutexString::substr(std::size_t pos, std::size_t count) const {
+template <typename LockPolicy, unsigned Features>
+std::string BasicMutexString<LockPolicy, Features>::substr(std::size_t pos, std::size_t count) const {
+#ifndef NDEBUG
+    assert_not_reentrant_();
+#endif
+    read_lock_type lock(m_); merge_();
+    return std::string(std::string_view(cur_()).substr(pos, count));   // std::string also with feature::pmr
+}
+template <typename LockPolicy, unsigned Features>
+std::size_t BasicMutexString<LockPolicy, Features>::copy(char* dest, std::size_t count, std::size_t pos) const {
+#ifndef NDEBUG
+    assert_not_reentrant_();
+#endif
+    read_lock_type lock(m_); merge_(); return cur_().copy(dest, count, pos);
+}
+template <typename LockPolicy, unsigned Features>
+int BasicMutexString<LockPolicy, Features>::compare(const std::string& s) const {
+#ifndef NDEBUG
+    assert_not_reentrant_();
+#endif
+    read_lock_type lock(m_); merge_(); return cur_().compare(s);
+}
+template <typename LockPolicy, unsigned Features>
+int BasicMutexString<LockPolicy, Features>::compare(std::size_t pos, std::size_t count, const std::string& s) const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.substr(pos, count);
+    read_lock_type lock(m_); merge_(); return cur_().compare(pos, count, s);
 }
-std::size_t MutexString::copy(char* dest, std::size_t count, std::size_t pos) const {
+
+template <typename LockPolicy, unsigned Features>
+std::size_t BasicMutexString<LockPolicy, Features>::find(const std::string& s, std::size_t pos) const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.copy(dest, count, pos);
+    read_lock_type lock(m_); merge_(); return detail::fast_find(cur_(), s, pos);
 }
-int MutexString::compare(const std::string& s) const {
+template <typename LockPolicy, unsigned Features>
+std::size_t BasicMutexString<LockPolicy, Features>::find(const char* s, std::size_t pos) const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.compare(s);
+    read_lock_type lock(m_); merge_(); return detail::fast_find(cur_(), s ? s : "", pos);
 }
-int MutexString::compare(std::size_t pos, std::size_t count, const std::string& s) const {
+template <typename LockPolicy, unsigned Features>
+std::size_t BasicMutexString<LockPolicy, Features>::find(char ch, std::size_t pos) const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.compare(pos, count, s);
+    read_lock_type lock(m_); merge_(); return detail::fast_find(cur_(), ch, pos);
 }
 
-std::size_t MutexString::find(const std::string& s, std::size_t pos) const {
+template <typename LockPolicy, unsigned Features>
+std::size_t BasicMutexString<LockPolicy, Features>::rfind(const std::string& s, std::size_t pos) const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.find(s, pos);
+    read_lock_type lock(m_); merge_(); return detail::fast_rfind(cur_(), s, pos);
 }
-std::size_t MutexString::find(const char* s, std::size_t pos) const {
+template <typename LockPolicy, unsigned Features>
+std::size_t BasicMutexString<LockPolicy, Features>::rfind(const char* s, std::size_t pos) const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.find(s ? s : "", pos);
+    read_lock_type lock(m_); merge_(); return detail::fast_rfind(cur_(), s ? s : "", pos);
 }
-std::size_t MutexString::find(char ch, std::size_t pos) const {
+template <typename LockPolicy, unsigned Features>
+std::size_t BasicMutexString<LockPolicy, Features>::rfind(char ch, std::size_t pos) const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.find(ch, pos);
+    read_lock_type lock(m_); merge_(); return detail::fast_rfind(cur_(), ch, pos);
 }
 
-std::size_t MutexString::rfind(const std::string& s, std::size_t pos) const {
+template <typename LockPolicy, unsigned Features>
+std::size_t BasicMutexString<LockPolicy, Features>::find_first_of(const std::string& s, std::size_t pos) const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.rfind(s, pos);
+    const detail::CharSet set(s);   // built before locking
+    read_lock_type lock(m_); merge_(); return detail::fast_find_of(cur_(), set, true, pos);
 }
-std::size_t MutexString::rfind(const char* s, std::size_t pos) const {
+template <typename LockPolicy, unsigned Features>
+std::size_t BasicMutexString<LockPolicy, Features>::find_first_of(const char* s, std::size_t pos) const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.rfind(s ? s : "", pos);
+    const detail::CharSet set(std::string_view(s ? s : ""));
+    read_lock_type lock(m_); merge_(); return detail::fast_find_of(cur_(), set, true, pos);
 }
-std::size_t MutexString::rfind(char ch, std::size_t pos) const {
+template <typename LockPolicy, unsigned Features>
+std::size_t BasicMutexString<LockPolicy, Features>::find_first_of(char ch, std::size_t pos) const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.rfind(ch, pos);
+    read_lock_type lock(m_); merge_(); return detail::fast_find(cur_(), ch, pos);   // no temporary std::string(1, ch)
 }
 
-std::size_t MutexString::find_first_of(const std::string& s, std::size_t pos) const {
+template <typename LockPolicy, unsigned Features>
+std::size_t BasicMutexString<LockPolicy, Features>::find_last_of(const std::string& s, std::size_t pos) const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.find_first_of(s, pos);
+    const detail::CharSet set(s);
+    read_lock_type lock(m_); merge_(); return detail::fast_rfind_of(cur_(), set, true, pos);
 }
-std::size_t MutexString::find_first_of(const char* s, std::size_t pos) const {
+template <typename LockPolicy, unsigned Features>
+std::size_t BasicMutexString<LockPolicy, Features>::find_last_of(const char* s, std::size_t pos) const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.find_first_of(s ? s : "", pos);
+    const detail::CharSet set(std::string_view(s ? s : ""));
+    read_lock_type lock(m_); merge_(); return detail::fast_rfind_of(cur_(), set, true, pos);
 }
-std::size_t MutexString::find_first_of(char ch, std::size_t pos) const {
+template <typename LockPolicy, unsigned Features>
+std::size_t BasicMutexString<LockPolicy, Features>::find_last_of(char ch, std::size_t pos) const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.find_first_of(std::string(1, ch), pos);
+    read_lock_type lock(m_); merge_(); return detail::fast_rfind(cur_(), ch, pos);
 }
 
-std::size_t MutexString::find_last_of(const std::string& s, std::size_t pos) const {
+template <typename LockPolicy, unsigned Features>
+std::size_t BasicMutexString<LockPolicy, Features>::find_first_not_of(const std::string& s, std::size_t pos) const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.find_last_of(s, pos);
+    const detail::CharSet set(s);
+    read_lock_type lock(m_); merge_(); return detail::fast_find_of(cur_(), set, false, pos);
 }
-std::size_t MutexString::find_last_of(const char* s, std::size_t pos) const {
+template <typename LockPolicy, unsigned Features>
+std::size_t BasicMutexString<LockPolicy, Features>::find_first_not_of(const char* s, std::size_t pos) const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.find_last_of(s ? s : "", pos);
+    const detail::CharSet set(std::string_view(s ? s : ""));
+    read_lock_type lock(m_); merge_(); return detail::fast_find_of(cur_(), set, false, pos);
 }
-std::size_t MutexString::find_last_of(char ch, std::size_t pos) const {
+template <typename LockPolicy, unsigned Features>
+std::size_t BasicMutexString<LockPolicy, Features>::find_first_not_of(char ch, std::size_t pos) const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.find_last_of(std::string(1, ch), pos);
+    const detail::CharSet set(ch);
+    read_lock_type lock(m_); merge_(); return detail::fast_find_of(cur_(), set, false, pos);
 }
 
-std::size_t MutexString::find_first_not_of(const std::string& s, std::size_t pos) const {
+template <typename LockPolicy, unsigned Features>
+std::size_t BasicMutexString<LockPolicy, Features>::find_last_not_of(const std::string& s, std::size_t pos) const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.find_first_not_of(s, pos);
+    const detail::CharSet set(s);
+    read_lock_type lock(m_); merge_(); return detail::fast_rfind_of(cur_(), set, false, pos);
 }
-std::size_t MutexString::find_first_not_of(const char* s, std::size_t pos) const {
+template <typename LockPolicy, unsigned Features>
+std::size_t BasicMutexString<LockPolicy, Features>::find_last_not_of(const char* s, std::size_t pos) const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.find_first_not_of(s ? s : "", pos);
+    const detail::CharSet set(std::string_view(s ? s : ""));
+    read_lock_type lock(m_); merge_(); return detail::fast_rfind_of(cur_(), set, false, pos);
 }
-std::size_t MutexString::find_first_not_of(char ch, std::size_t pos) const {
+template <typename LockPolicy, unsigned Features>
+std::size_t BasicMutexString<LockPolicy, Features>::find_last_not_of(char ch, std::size_t pos) const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.find_first_not_of(std::string(1, ch), pos);
+    const detail::CharSet set(ch);
+    read_lock_type lock(m_); merge_(); return detail::fast_rfind_of(cur_(), set, false, pos);
 }
 
-std::size_t MutexString::find_last_not_of(const std::string& s, std::size_t pos) const {
+template <typename LockPolicy, unsigned Features>
+std::optional<PatternMatch> BasicMutexString<LockPolicy, Features>::find_any(const PatternSet& patterns, std::size_t pos) const {
+#ifndef NDEBUG
+    assert_not_reentrant_();
+#endif
+    read_lock_type lock(m_); merge_(); return patterns.find_any(cur_(), pos);
+}
+template <typename LockPolicy, unsigned Features>
+std::vector<PatternMatch> BasicMutexString<LockPolicy, Features>::find_all(const PatternSet& patterns, std::size_t pos) const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.find_last_not_of(s, pos);
+    read_lock_type lock(m_); merge_(); return patterns.find_all(cur_(), pos);
 }
-std::size_t MutexString::find_last_not_of(const char* s, std::size_t pos) const {
+
+template <typename LockPolicy, unsigned Features>
+std::size_t BasicMutexString<LockPolicy, Features>::find(const Searcher& searcher, std::size_t pos) const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.find_last_not_of(s ? s : "", pos);
+    read_lock_type lock(m_); merge_(); return searcher.find(cur_(), pos);
 }
-std::size_t MutexString::find_last_not_of(char ch, std::size_t pos) const {
+template <typename LockPolicy, unsigned Features>
+std::size_t BasicMutexString<LockPolicy, Features>::count(const Searcher& searcher, std::size_t pos) const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_.find_last_not_of(std::string(1, ch), pos);
+    read_lock_type lock(m_); merge_(); return searcher.count(cur_(), pos);
+}
+
+template <typename LockPolicy, unsigned Features>
+std::size_t BasicMutexString<LockPolicy, Features>::parallel_find(std::string_view needle, std::size_t pos,
+                                                                  const ParallelOptions& options) const {
+    const Snapshot snap = snapshot();
+    return j2::parallel_find(snap.view(), needle, pos, options);
+}
+template <typename LockPolicy, unsigned Features>
+std::size_t BasicMutexString<LockPolicy, Features>::parallel_count(std::string_view needle, const ParallelOptions& options) const {
+    const Snapshot snap = snapshot();
+    return j2::parallel_count(snap.view(), needle, options);
 }
 
 // ===== safe convenience =====
-std::string MutexString::str() const {
+template <typename LockPolicy, unsigned Features>
+std::string BasicMutexString<LockPolicy, Features>::str() const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    std::scoped_lock lock(m_); return s_;
+    if constexpr (cow_snapshots) {
+        {
+            // a short value is copied under the lock: sharing it would cost a heap buffer the copy does not need
+            read_lock_type lock(m_); merge_();
+            if (cur_().size() <= detail::sso_capacity<string_type>()) return std::string(cur_());
+        }
+        return snapshot().str();   // O(1) under the lock, the O(n) copy happens after unlocking
+    } else {
+        read_lock_type lock(m_); merge_(); return std::string(cur_());
+    }
+}
+
+template <typename LockPolicy, unsigned Features>
+typename BasicMutexString<LockPolicy, Features>::Snapshot BasicMutexString<LockPolicy, Features>::snapshot() const {
+#ifndef NDEBUG
+    assert_not_reentrant_();
+#endif
+    if constexpr (cow_snapshots) {
+        if constexpr (shared_reads) {
+            // already shared since the last write: readers only copy the pointer
+            read_lock_type lock(m_);
+            if (this->snap_) return Snapshot{this->snap_};
+        }
+        std::scoped_lock lock(m_);
+        merge_();
+        share_();
+        return Snapshot{this->snap_};
+    } else {
+        read_lock_type lock(m_); merge_();
+        return Snapshot{std::make_shared<const std::string>(cur_())};
+    }
+}
+
+// ===== copy-on-write support =====
+template <typename LockPolicy, unsigned Features>
+void BasicMutexString<LockPolicy, Features>::share_() const {
+    if constexpr (cow_snapshots) {
+        if (this->snap_) return;
+        if (this->pooled_) {
+            // a Snapshot must not depend on the pool's lifetime: the entry is copied once into an owned buffer
+            this->snap_ = std::make_shared<std::string>(*this->pooled_);
+            this->pooled_ = nullptr;
+        } else {
+            // move, not copy: the value changes its storage, not its contents
+            this->snap_ = std::make_shared<std::string>(std::move(s_));
+        }
+    }
+}
+
+template <typename LockPolicy, unsigned Features>
+void BasicMutexString<LockPolicy, Features>::detach_() const {
+    if constexpr (cow_snapshots) {
+        if (this->pooled_) {
+            s_ = *this->pooled_;   // the deferred copy of assign(Interned)
+            this->pooled_ = nullptr;
+            return;
+        }
+        if (!this->snap_) return;
+        if (this->snap_.use_count() == 1) {
+            // every Snapshot handle is gone: take the buffer back without copying
+            // (acquire pairs with the release decrement of the last handle dropped in another thread)
+            std::atomic_thread_fence(std::memory_order_acquire);
+            s_ = std::move(*this->snap_);
+        } else {
+            s_ = *this->snap_;   // still referenced by a Snapshot
+        }
+        this->snap_.reset();
+    }
+}
+
+// ===== change notification (feature::versioned) =====
+template <typename LockPolicy, unsigned Features>
+bool BasicMutexString<LockPolicy, Features>::await_change_(std::uint64_t last,
+                                                           std::chrono::steady_clock::time_point deadline) const {
+    if constexpr (versioned) {
+        if (this->version_.load(std::memory_order_acquire) != last) return true;
+        auto& word = detail::parking_word(this);
+        this->waiters_.fetch_add(1, std::memory_order_seq_cst);
+        bool changed = false;
+        for (;;) {
+            // wake sequence first, then the condition: a bump in between makes the wait return at once
+            std::uint32_t seq = word.load(std::memory_order_seq_cst);
+            if (this->version_.load(std::memory_order_seq_cst) != last) { changed = true; break; }
+            if (deadline == std::chrono::steady_clock::time_point::max()) {
+                detail::futex_wait(&word, seq);
+            } else {
+                auto now = std::chrono::steady_clock::now();
+                if (now >= deadline) break;
+                detail::futex_wait_for(&word, seq, deadline - now);
+            }
+        }
+        this->waiters_.fetch_sub(1, std::memory_order_relaxed);
+        return changed;
+    } else {
+        (void)last; (void)deadline;
+        return false;
+    }
+}
+
+// ===== change listeners (feature::notify) =====
+template <typename LockPolicy, unsigned Features>
+Subscription BasicMutexString<LockPolicy, Features>::subscribe_(ChangeListener fn, SubscribeOptions options) const {
+    if constexpr (notifies) {
+#ifndef NDEBUG
+        assert_not_reentrant_();
+#endif
+        std::scoped_lock lock(m_);
+        if (!this->listeners_) this->listeners_ = new detail::ListenerSet;
+        auto e = std::make_shared<detail::ListenerEntry>(std::move(fn), std::move(options.executor), options.snapshot,
+                                                         this->version_.load(std::memory_order_relaxed));
+        this->listeners_->entries.push_back(e);
+        return Subscription{std::move(e)};
+    } else {
+        (void)fn; (void)options;
+        return {};
+    }
+}
+
+template <typename LockPolicy, unsigned Features>
+void BasicMutexString<LockPolicy, Features>::notify_() const noexcept {
+    if constexpr (notifies) {
+        std::optional<Snapshot> value;
+        if (this->listeners_->wants_snapshot()) {
+            try {
+                if constexpr (cow_snapshots) {
+                    // same as snapshot(): the value moves into the shared buffer, the next writer takes it back
+                    // (or copies it while a listener still holds the event)
+                    share_();
+                    value.emplace(this->snap_);
+                } else {
+                    value.emplace(std::make_shared<const std::string>(cur_()));
+                }
+            } catch (...) {
+                // out of memory: the listeners get the versions without the value
+            }
+        }
+        this->listeners_->dispatch(this->version_.load(std::memory_order_relaxed), value);
+    }
 }
 
 // ===== full API access =====
-MutexString::Locked MutexString::synchronize() {
+template <typename LockPolicy, unsigned Features>
+typename BasicMutexString<LockPolicy, Features>::Locked BasicMutexString<LockPolicy, Features>::synchronize() {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
     return Locked{s_, m_, this};
 }
-MutexString::Locked MutexString::synchronize() const {
+template <typename LockPolicy, unsigned Features>
+typename BasicMutexString<LockPolicy, Features>::Locked BasicMutexString<LockPolicy, Features>::synchronize() const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    return Locked{s_, m_, this};
+    return Locked{std::as_const(s_), m_, this};   // s_ is mutable: pick the read-only guard explicitly
+}
+
+template <typename LockPolicy, unsigned Features>
+typename BasicMutexString<LockPolicy, Features>::Locked BasicMutexString<LockPolicy, Features>::try_guard() {
+#ifndef NDEBUG
+    assert_not_reentrant_();
+#endif
+    return Locked{s_, m_, this, std::try_to_lock};
+}
+template <typename LockPolicy, unsigned Features>
+typename BasicMutexString<LockPolicy, Features>::Locked BasicMutexString<LockPolicy, Features>::try_guard() const {
+#ifndef NDEBUG
+    assert_not_reentrant_();
+#endif
+    return Locked{std::as_const(s_), m_, this, std::try_to_lock};
 }
 
 // ===== protected: RAII c_str() (not exposed externally) =====
-MutexString::CStrGuard MutexString::c_str() const {
+template <typename LockPolicy, unsigned Features>
+typename BasicMutexString<LockPolicy, Features>::CStrGuard BasicMutexString<LockPolicy, Features>::c_str() const {
 #ifndef NDEBUG
     assert_not_reentrant_();
 #endif
-    return CStrGuard{s_, m_};
+    return CStrGuard{s_, m_, this};
 }
 
+// ===== explicit instantiations =====
+// member definitions live in this translation unit, so every lock policy / feature combination
+// offered by MutexString.hpp is instantiated here (add a line for a custom one)
+template class BasicMutexString<std::mutex>;
+template class BasicMutexString<std::mutex, feature::none>;
+template class BasicMutexString<std::mutex, feature::standard | feature::combining_append>;
+template class BasicMutexString<std::mutex, feature::sharded_append>;
+template class BasicMutexString<std::shared_mutex>;
+template class BasicMutexString<SpinLock>;
+template class BasicMutexString<NullLock>;
+template class BasicMutexString<AdaptiveLock>;
+template class BasicMutexString<CompactLock, feature::none>;
+template class BasicMutexString<std::mutex, feature::size_mirror | feature::pmr>;
+template class BasicMutexString<std::mutex, feature::standard | feature::cache_aligned>;
+template class BasicMutexString<std::mutex, feature::standard | feature::notify>;
+#if !defined(J2_MUTEX_STRING_MEMORY_STATS)
+template class BasicMutexString<std::mutex, feature::standard | feature::memory_stats>;
+#endif
+
 } // namespace j2
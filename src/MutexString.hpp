@@ -1,54 +1,365 @@
 #pragma once
 #include <string>
 #include <mutex>
+#include <shared_mutex>
 #include <utility>
 #include <type_traits>
 #include <cassert>
+#include <atomic>
+#include <cstddef>
+#include <string_view>
+#include <exception>
+#include <optional>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include <memory_resource>
+#include <cstdint>
+#include <vector>
+
+#include "LockPolicy.hpp"
+#include "Snapshot.hpp"
+#include "InternPool.hpp"
+#include "ChangeListener.hpp"
+#include "PatternSet.hpp"
+#include "ParallelSearch.hpp"
+#include "Searcher.hpp"
 
 // j2 namespace
 namespace j2 {
 
+namespace detail {
+
+// non-template part shared by every BasicMutexString instantiation
+class MutexStringBase {
+protected:
+#ifndef NDEBUG
+    // debug-only: object whose lock this thread holds inside with()/guard() (defined in MutexString.cpp)
+    // kept out of the class template: a static thread_local member of a template is not reliably
+    // initialized across the extern template boundary
+    static thread_local const void* tls_owner_;
+#endif
+};
+
+// cache line size assumed for padding (x86-64, most AArch64 cores)
+// std::hardware_destructive_interference_size is not used: its value may differ between compilers/flags,
+// which would change the layout of classes seen by other translation units
+inline constexpr std::size_t kCacheLine = 64;
+
+// lock-free copy of size()/capacity() (feature::size_mirror)
+// - stored by writers while they hold the lock, loaded by readers without it
+template <bool Enabled>
+struct SizeMirror {
+    mutable std::atomic<std::size_t> size_{0};
+    mutable std::atomic<std::size_t> capacity_{0};
+};
+template <>
+struct SizeMirror<false> {};
+
+// one append waiting for a combiner (feature::combining_append); lives on the caller's stack
+struct AppendRequest {
+    std::string_view text;
+    std::size_t fill = 0;            // append(fill, ch) instead of text when non-zero
+    char ch = '\0';
+    AppendRequest* next = nullptr;
+    std::exception_ptr error;        // set by the combiner if this append threw
+    // kQueued → kDone by the combiner; kQueued → kParked by the owner before it sleeps on the word
+    static constexpr std::uint32_t kQueued = 0, kDone = 1, kParked = 2;
+    std::atomic<std::uint32_t> state{kQueued};
+
+    template <typename String>
+    void apply(String& s) const {
+        if (fill) s.append(fill, ch);
+        else s.append(text);
+    }
+};
+
+// head of the published append requests (lock-free stack)
+template <bool Enabled>
+struct AppendCombiner {
+    std::atomic<AppendRequest*> pending_{nullptr};
+};
+template <>
+struct AppendCombiner<false> {};
+
+// buffer shared with Snapshot handles (feature::cow_snapshot)
+template <bool Enabled>
+struct SharedValue {
+    mutable std::shared_ptr<std::string> snap_;   // non-null: holds the current value (handed out const), s_ is moved-from
+    mutable const std::string* pooled_ = nullptr;         // non-null: an InternPool entry holds the current value
+};
+template <>
+struct SharedValue<false> {};
+
+// heap/capacity accounting (feature::memory_stats)
+// - process-wide totals are kept in per-thread-sharded counters (MutexString.cpp), so accounting writers
+//   on different threads do not bounce one cache line
+void account_memory(std::ptrdiff_t instances, std::ptrdiff_t size, std::ptrdiff_t capacity,
+                    std::ptrdiff_t heap, std::size_t reallocations) noexcept;
+
+// std::string capacity that fits the in-object (SSO) buffer: up to this nothing is on the heap
+template <typename String>
+std::size_t sso_capacity() noexcept {
+    static const std::size_t cap = String().capacity();
+    return cap;
+}
+
+// per-instance figures, written by commit_() under the exclusive lock and read under the read lock
+template <bool Enabled>
+struct MemoryAccount {
+    MemoryAccount() noexcept { account_memory(1, 0, 0, 0, 0); }
+    MemoryAccount(const MemoryAccount&) = delete;   // the owner's copy/move re-records through commit_()
+    MemoryAccount& operator=(const MemoryAccount&) = delete;
+    ~MemoryAccount() {
+        account_memory(-1, -static_cast<std::ptrdiff_t>(acct_size_), -static_cast<std::ptrdiff_t>(acct_capacity_),
+                       -static_cast<std::ptrdiff_t>(acct_heap_), 0);
+    }
+
+    // new figures of the current value; a change of the heap block size counts as one reallocation
+    void account_(std::size_t size, std::size_t capacity, std::size_t heap) const noexcept {
+        const std::size_t reallocs = (heap != acct_heap_ && heap != 0) ? 1 : 0;
+        if (size == acct_size_ && capacity == acct_capacity_ && !reallocs) return;
+        account_memory(0, static_cast<std::ptrdiff_t>(size) - static_cast<std::ptrdiff_t>(acct_size_),
+                       static_cast<std::ptrdiff_t>(capacity) - static_cast<std::ptrdiff_t>(acct_capacity_),
+                       static_cast<std::ptrdiff_t>(heap) - static_cast<std::ptrdiff_t>(acct_heap_), reallocs);
+        acct_size_ = size;
+        acct_capacity_ = capacity;
+        acct_heap_ = heap;
+        acct_reallocs_ += reallocs;
+    }
+
+    mutable std::size_t acct_size_ = 0;
+    mutable std::size_t acct_capacity_ = 0;
+    mutable std::size_t acct_heap_ = 0;
+    mutable std::size_t acct_reallocs_ = 0;
+};
+template <>
+struct MemoryAccount<false> {};
+
+// change counter and sleeping-reader count (feature::versioned)
+// - version_ is bumped by every writer after it committed; waiters park on the object's parking-lot word
+// - waiters_ lets writers skip the wake-up call when nobody waits
+template <bool Enabled>
+struct VersionCounter {
+    mutable std::atomic<std::uint64_t> version_{0};
+    mutable std::atomic<std::uint32_t> waiters_{0};
+};
+template <>
+struct VersionCounter<false> {};
+
+// registered change listeners (feature::notify), allocated by the first subscribe()
+template <bool Enabled>
+struct ChangeListeners {
+    ChangeListeners() = default;
+    ChangeListeners(const ChangeListeners&) = delete;   // listeners stay with the object they subscribed to
+    ChangeListeners& operator=(const ChangeListeners&) = delete;
+    ~ChangeListeners() { delete listeners_; }
+
+    mutable ListenerSet* listeners_ = nullptr;   // set and used under the exclusive lock
+};
+template <>
+struct ChangeListeners<false> {};
+
+// empty base that raises the alignment of the object to a cache line (feature::cache_aligned)
+template <bool Enabled>
+struct alignas(kCacheLine) LineAligned {};
+template <>
+struct LineAligned<false> {};
+
+// result of try_with()/with_for()/with_until(): std::optional<R>, or bool when fn returns void
+template <typename R>
+using try_result_t = std::conditional_t<std::is_void_v<R>, bool, std::optional<std::remove_cv_t<std::remove_reference_t<R>>>>;
+
+// per-thread append buffers of one object (feature::sharded_append)
+// - a thread always uses the same shard (this_thread_shard()), so appenders of different threads touch
+//   different cache lines and only meet when there are more threads than shards
+// - pending is read without the shard lock so a merge can skip idle shards
+struct alignas(kCacheLine) AppendShard {
+    CompactLock lock;   // parks instead of spinning if the holder is preempted
+    std::atomic<bool> pending{false};
+    std::string buf;
+};
+inline constexpr std::size_t kAppendShards = 16;
+struct AppendShardSet {
+    AppendShard shard[kAppendShards];
+};
+unsigned this_thread_shard() noexcept;   // MutexString.cpp
+
+// shard set, allocated by the first append
+template <bool Enabled>
+struct AppendShards {
+    AppendShards() = default;
+    AppendShards(const AppendShards&) = delete;
+    AppendShards& operator=(const AppendShards&) = delete;
+    ~AppendShards() { delete shards_.load(std::memory_order_relaxed); }
+
+    std::atomic<AppendShardSet*> shards_{nullptr};
+};
+template <>
+struct AppendShards<false> {};
+
+} // namespace detail
+
+// per-instance features of BasicMutexString (bit mask, second template argument)
+// - every feature adds state to each object, so size-critical variants can leave them out
+namespace feature {
+inline constexpr unsigned none             = 0;
+inline constexpr unsigned size_mirror      = 1u << 0;  // size()/length()/empty()/capacity() without taking the lock
+inline constexpr unsigned combining_append = 1u << 1;  // contended append/+=/push_back are batched by one lock holder
+inline constexpr unsigned sharded_append   = 1u << 2;  // append/+=/push_back go to per-thread shards, merged on read
+inline constexpr unsigned cow_snapshot     = 1u << 3;  // snapshot() shares the buffer, writers copy only if it is still shared
+inline constexpr unsigned pmr              = 1u << 4;  // the value is a std::pmr::string (allocates from a memory_resource)
+inline constexpr unsigned cache_aligned    = 1u << 5;  // each object starts on its own cache line (padded to whole lines)
+inline constexpr unsigned memory_stats     = 1u << 6;  // per-object and process-wide size/capacity/heap/reallocation counts
+inline constexpr unsigned versioned        = 1u << 7;  // version() bumped by every write, wait_for_change()/wait_until()
+inline constexpr unsigned notify           = 1u << 8;  // subscribe(): listeners called after every write (needs versioned)
+#if defined(J2_MUTEX_STRING_MEMORY_STATS)
+// CMake option MUTEX_STRING_MEMORY_STATS: every standard object (jstr) is accounted
+inline constexpr unsigned standard         = size_mirror | cow_snapshot | versioned | memory_stats;
+#else
+inline constexpr unsigned standard         = size_mirror | cow_snapshot | versioned;
+#endif
+} // namespace feature
+
+// memory figures of one object (memory_usage()) and of all accounted objects (memory_totals())
+struct MemoryUsage {
+    std::size_t size = 0;
+    std::size_t capacity = 0;
+    std::size_t heap_bytes = 0;          // size of the heap block (0 while the value fits the SSO buffer)
+    std::size_t reallocations = 0;       // heap block changes so far (feature::memory_stats only)
+    std::size_t slack() const { return capacity - size; }   // capacity left unused (e.g. after clear()/erase())
+};
+struct MemoryTotals {
+    std::size_t instances = 0;           // live objects with feature::memory_stats
+    std::size_t size = 0;
+    std::size_t capacity = 0;
+    std::size_t heap_bytes = 0;
+    std::size_t reallocations = 0;       // cumulative, including destroyed objects
+    std::size_t slack() const { return capacity - size; }
+};
+// sums over every live object with feature::memory_stats (a consistent-enough monitoring read, not a snapshot)
+MemoryTotals memory_totals() noexcept;
+
 // thread-safe string wrapper
-// - only members are std::string and std::mutex
+// - members are std::string (std::pmr::string with feature::pmr), the lock (LockPolicy, std::mutex by default) and the state of enabled Features
 // - std::string API is provided with identical/similar signatures as much as possible
 // - returning pointer/iterator/reference directly is dangerous, so access only via guard() or snapshot (str)
-class MutexString {
+// - LockPolicy: std::mutex, std::shared_mutex, SpinLock, AdaptiveLock, CompactLock, NullLock (see LockPolicy.hpp)
+// - Features: feature::* bit mask (feature::standard by default)
+template <typename LockPolicy, unsigned Features = feature::standard>
+class BasicMutexString : public detail::MutexStringBase
+                       , protected detail::SizeMirror<(Features & feature::size_mirror) != 0>
+                       , protected detail::AppendCombiner<(Features & feature::combining_append) != 0>
+                       , protected detail::AppendShards<(Features & feature::sharded_append) != 0>
+                       , protected detail::SharedValue<(Features & feature::cow_snapshot) != 0>
+                       , protected detail::LineAligned<(Features & feature::cache_aligned) != 0>
+                       , protected detail::MemoryAccount<(Features & feature::memory_stats) != 0>
+                       , protected detail::VersionCounter<(Features & feature::versioned) != 0>
+                       , protected detail::ChangeListeners<(Features & feature::notify) != 0> {
 public:
+    using lock_type = LockPolicy;
+
+    // polymorphic allocation: the value is a std::pmr::string built on the memory_resource given at
+    // construction (std::pmr::get_default_resource() otherwise), e.g. a per-request monotonic arena
+    // - the resource is fixed for the object's lifetime: copies/moves from other objects copy characters into
+    //   it, and it must outlive the object
+    // - with() / guard() expose std::pmr::string; str()/substr() still return std::string
+    // - no copy-on-write snapshots (a Snapshot owns a std::string): snapshot() copies the value
+    static constexpr bool uses_pmr = (Features & feature::pmr) != 0;
+    using string_type = std::conditional_t<uses_pmr, std::pmr::string, std::string>;
+    using allocator_type = typename string_type::allocator_type;
+
+    using Snapshot = j2::Snapshot;   // immutable, reference-counted value (jstr::Snapshot)
+    using SnapshotView = j2::SnapshotView;
+    static constexpr unsigned features = Features;
+
+    // sharded appends: append()/operator+=/push_back() only lock the calling thread's shard; every other
+    // member first merges pending shards into the string in shard order, under the exclusive lock
+    // - appends of one thread keep their order; appends of different threads made between two merges
+    //   are ordered by shard, not by time (use for accumulators such as traces, not for ordered logs)
+    static constexpr bool shards_appends = (Features & feature::sharded_append) != 0;
+
+    // size()/length()/empty()/capacity() read an atomic copy kept up to date by every writer;
+    // the value is the one published by the last completed write (a monitoring-grade answer)
+    // (not with sharded appends: the length then depends on a merge)
+    static constexpr bool mirrors_size = (Features & feature::size_mirror) != 0 && !shards_appends;
+
+    // flat combining: a contended append()/operator+=/push_back() publishes a request instead of queueing
+    // on the lock; whichever thread gets the lock applies every pending request in one pass
+    // (one lock handoff and one cache-line migration of the buffer per batch instead of per call)
+    static constexpr bool combines_appends = (Features & feature::combining_append) != 0 && !shards_appends;
+
+    // copy-on-write snapshots: snapshot() moves the value into a reference-counted buffer in O(1) and
+    // hands out references to it; the next writer takes the buffer back if no Snapshot is left, or copies it
+    static constexpr bool cow_snapshots = (Features & feature::cow_snapshot) != 0 && !uses_pmr;
+
+    // cache-line alignment: the lock and string header of one object never share a line with a neighbour,
+    // so threads that each lock their own element of an array/vector or struct do not false-share
+    // (sizeof becomes a multiple of the line)
+    static constexpr bool cache_aligned = (Features & feature::cache_aligned) != 0;
+
+    // memory accounting: every writer records size, capacity and heap block size of the value as it commits,
+    // and adds the change to process-wide totals (memory_totals()); a new heap block counts as a reallocation
+    // (append shards are not counted; a buffer shared with snapshots or an InternPool entry counts for
+    // every object currently holding it)
+    static constexpr bool accounts_memory = (Features & feature::memory_stats) != 0;
+
+    // change versions: every mutator bumps version() once it has committed (append to a shard included, and
+    // every request of a combined append batch); readers block in wait_for_change()/wait_until() and are woken
+    // by the next write instead of polling
+    static constexpr bool versioned = (Features & feature::versioned) != 0;
+
+    // change listeners: every committed write posts (old version, new version[, snapshot]) to each subscriber's
+    // executor; the listener runs there, after the writer released the lock
+    // (not with sharded appends: an append is only a write of the value once it is merged)
+    static constexpr bool notifies = (Features & feature::notify) != 0 && !shards_appends;
+    static_assert(!(Features & feature::notify) || versioned, "feature::notify needs feature::versioned");
+
+    // lock taken by const members: shared when LockPolicy is a shared (reader-writer) lock, exclusive otherwise
+    // (exclusive with sharded appends, since a read may merge)
+    static constexpr bool shared_reads = is_shared_lockable_v<LockPolicy> && !shards_appends;
+    using read_lock_type = std::conditional_t<shared_reads, std::shared_lock<LockPolicy>, std::unique_lock<LockPolicy>>;
+
     // locked view (guard): holds the mutex during lifetime and provides direct access to internal std::string
     class Locked {
     public:
         // ⚠️ for reentrancy detection, the pointer to owner (protected target object) is also passed
-        Locked(std::string& s, std::mutex& m, const MutexString* owner);
-        Locked(const std::string& s, std::mutex& m, const MutexString* owner);
+        Locked(string_type& s, LockPolicy& m, const BasicMutexString* owner);
+        Locked(const string_type& s, LockPolicy& m, const BasicMutexString* owner);
+        // try_guard(): does not wait; the guard is empty (owns_lock() == false, no access) if the lock was busy
+        Locked(string_type& s, LockPolicy& m, const BasicMutexString* owner, std::try_to_lock_t);
+        Locked(const string_type& s, LockPolicy& m, const BasicMutexString* owner, std::try_to_lock_t);
         ~Locked(); // release reentrancy mark in debug mode
 
         // internal std::string full API can be used during guard lifetime
-        std::string* operator->();
-        const std::string* operator->() const;
-        std::string& operator*();
-        const std::string& operator*() const;
+        string_type* operator->();
+        const string_type* operator->() const;
+        string_type& operator*();
+        const string_type& operator*() const;
 
         // early unlock and status check if needed
         [[deprecated("Avoid using unlock() unless in special cases. Narrow down guard lifetime.")]]
         void unlock();
         bool owns_lock() const;
+        explicit operator bool() const { return owns_lock(); }   // if (auto g = ms.try_guard()) { ... }
 
     protected:
         // ⚠ protected: block helpers that extract pointer directly from external code (prevent misuse)
         const char* guard_cstr() const;  // == (cs_ ? cs_ : s_)->c_str()
 
         // internal state
-        std::string* s_ = nullptr;
-        const std::string* cs_ = nullptr;
-        std::unique_lock<std::mutex> lock_;
+        string_type* s_ = nullptr;
+        const string_type* cs_ = nullptr;
+        std::unique_lock<LockPolicy> lock_;  // held by a mutable guard
+        read_lock_type rlock_;               // held by a const guard
+        const BasicMutexString* owner_ = nullptr;  // commit target on release (+ reentrancy control)
 
 #ifndef NDEBUG
         // debug-only reentrancy control
-        const MutexString* owner_ = nullptr;
         bool mark_set_ = false;
 #endif
 
-        friend class MutexString; // MutexString can access internally
+        friend class BasicMutexString; // BasicMutexString can access internally
     };
 
     // RAII pointer guard (internal use)
@@ -56,42 +367,62 @@ public:
     // - keeps lock during object lifetime → safe to pass directly as function arguments
     class CStrGuard {
     public:
-        CStrGuard(const std::string& s, std::mutex& m);
+        CStrGuard(const string_type& s, LockPolicy& m, const BasicMutexString* owner);
         const char* get() const { return p_; }
         operator const char*() const { return p_; } // allow direct argument passing
         CStrGuard(const CStrGuard&) = delete;
         CStrGuard& operator=(const CStrGuard&) = delete;
     private:
-        std::unique_lock<std::mutex> lock_;
+        read_lock_type lock_;
         const char* p_ = nullptr;
     };
 
 public:
     // ===== constructors/assignments =====
-    MutexString() = default;                 // empty string
+    BasicMutexString();                           // empty string
 
     // ⬇⬇⬇ explicit removed → allows "j2::MutexString ms = \"start\";" / "jstr ms = \"start\";"
-    MutexString(std::string s);
-    MutexString(const char* s);
+    BasicMutexString(std::string s);
+    BasicMutexString(const char* s);
+    BasicMutexString(Interned v);                  // shares the pool's storage with cow_snapshot (see assign(Interned))
 
-    MutexString(const MutexString& other);
-    MutexString(MutexString&& other) noexcept;
-    MutexString& operator=(const MutexString& other);
-    MutexString& operator=(MutexString&& other) noexcept;
+    // feature::pmr only: allocate from mr (not owned, must outlive the object)
+    template <bool P = uses_pmr, std::enable_if_t<P, int> = 0>
+    explicit BasicMutexString(std::pmr::memory_resource* mr) : s_(allocator_type(mr)) { commit_(); }
+    template <bool P = uses_pmr, std::enable_if_t<P, int> = 0>
+    BasicMutexString(std::string_view s, std::pmr::memory_resource* mr) : s_(s, allocator_type(mr)) { commit_(); }
+
+    BasicMutexString(const BasicMutexString& other);
+    BasicMutexString(BasicMutexString&& other) noexcept;
+    BasicMutexString& operator=(const BasicMutexString& other);
+    BasicMutexString& operator=(BasicMutexString&& other) noexcept;
 
     // assignment from std::string/char* (write)
-    MutexString& operator=(const std::string& rhs);
-    MutexString& operator=(const char* rhs);
+    BasicMutexString& operator=(const std::string& rhs);
+    BasicMutexString& operator=(const char* rhs);
+    BasicMutexString& operator=(Interned v) { assign(v); return *this; }
 
     // comparison (read)
     bool operator==(const std::string& rhs) const;
     bool operator==(const char* rhs) const;
     bool operator!=(const std::string& rhs) const { return !(*this == rhs); }
     bool operator!=(const char* rhs) const { return !(*this == rhs); }
-    friend inline bool operator==(const std::string& lhs, const MutexString& rhs) { return rhs == lhs; }
-    friend inline bool operator==(const char* lhs, const MutexString& rhs) { return rhs == lhs; }
-    friend inline bool operator!=(const std::string& lhs, const MutexString& rhs) { return !(rhs == lhs); }
-    friend inline bool operator!=(const char* lhs, const MutexString& rhs) { return !(rhs == lhs); }
+    friend inline bool operator==(const std::string& lhs, const BasicMutexString& rhs) { return rhs == lhs; }
+    friend inline bool operator==(const char* lhs, const BasicMutexString& rhs) { return rhs == lhs; }
+    friend inline bool operator!=(const std::string& lhs, const BasicMutexString& rhs) { return !(rhs == lhs); }
+    friend inline bool operator!=(const char* lhs, const BasicMutexString& rhs) { return !(rhs == lhs); }
+
+    // pointer compare while this object still holds v's pool entry (text compare otherwise)
+    bool operator==(const Interned& v) const;
+    bool operator!=(const Interned& v) const { return !(*this == v); }
+    friend inline bool operator==(const Interned& lhs, const BasicMutexString& rhs) { return rhs == lhs; }
+    friend inline bool operator!=(const Interned& lhs, const BasicMutexString& rhs) { return !(rhs == lhs); }
+
+    // size/capacity/heap bytes of the value (plus reallocations with feature::memory_stats)
+    MemoryUsage memory_usage() const;
+
+    // allocator of the value (std::pmr::polymorphic_allocator<char> with feature::pmr)
+    allocator_type get_allocator() const noexcept { return s_.get_allocator(); }
 
     // ===== capacity/status =====
     std::size_t size() const;
@@ -121,36 +452,40 @@ public:
     void assign(const std::string& s);
     void assign(const char* s);
     void assign(std::size_t count, char ch);
+    // interned value: with cow_snapshot the object drops its own buffer and reads the pool entry
+    // (no copy, equal values share storage; the first write copies it back); otherwise the text is copied
+    // - the pool must outlive the object while it holds the entry (InternPool::global() always does)
+    void assign(Interned v);
 
     // append (chained: returns MutexString&)
-    MutexString& append(const std::string& s);
-    MutexString& append(const char* s);
-    MutexString& append(std::size_t count, char ch);
+    BasicMutexString& append(const std::string& s);
+    BasicMutexString& append(const char* s);
+    BasicMutexString& append(std::size_t count, char ch);
 
     // operator+=
-    MutexString& operator+=(const std::string& s);
-    MutexString& operator+=(const char* s);
-    MutexString& operator+=(char ch);
+    BasicMutexString& operator+=(const std::string& s);
+    BasicMutexString& operator+=(const char* s);
+    BasicMutexString& operator+=(char ch);
 
     // insert
-    MutexString& insert(std::size_t pos, const std::string& s);
-    MutexString& insert(std::size_t pos, const char* s);
-    MutexString& insert(std::size_t pos, std::size_t count, char ch);
+    BasicMutexString& insert(std::size_t pos, const std::string& s);
+    BasicMutexString& insert(std::size_t pos, const char* s);
+    BasicMutexString& insert(std::size_t pos, std::size_t count, char ch);
 
     // erase
-    MutexString& erase(std::size_t pos = 0, std::size_t count = std::string::npos);
+    BasicMutexString& erase(std::size_t pos = 0, std::size_t count = std::string::npos);
 
     // replace
-    MutexString& replace(std::size_t pos, std::size_t count, const std::string& s);
-    MutexString& replace(std::size_t pos, std::size_t count, const char* s);
-    MutexString& replace(std::size_t pos, std::size_t count, std::size_t n, char ch);
+    BasicMutexString& replace(std::size_t pos, std::size_t count, const std::string& s);
+    BasicMutexString& replace(std::size_t pos, std::size_t count, const char* s);
+    BasicMutexString& replace(std::size_t pos, std::size_t count, std::size_t n, char ch);
 
     // resize
     void resize(std::size_t n);
     void resize(std::size_t n, char ch);
 
     // swap
-    void swap(MutexString& other);          // between MutexStrings
+    void swap(BasicMutexString& other);          // between MutexStrings
     void swap(std::string& other_str);      // between internal string and std::string
 
     // ===== string operations =====
@@ -184,38 +519,166 @@ public:
     std::size_t find_last_not_of(const char* s, std::size_t pos = std::string::npos) const;
     std::size_t find_last_not_of(char ch, std::size_t pos = std::string::npos) const;
 
+    // multi-pattern search: every pattern of a compiled PatternSet in one pass over the value, under one read lock
+    // (instead of one find() and one lock acquisition per keyword); offsets are positions in the value
+    std::optional<PatternMatch> find_any(const PatternSet& patterns, std::size_t pos = 0) const;
+    std::vector<PatternMatch> find_all(const PatternSet& patterns, std::size_t pos = 0) const;
+
+    // precompiled needle (Searcher.hpp): analyzed once, reused across calls and objects
+    // - count(): occurrences, overlapping ones included
+    std::size_t find(const Searcher& searcher, std::size_t pos = 0) const;
+    std::size_t count(const Searcher& searcher, std::size_t pos = 0) const;
+
+    // search of large values on a thread pool (ParallelSearch.hpp): the lock is held only to take a snapshot()
+    // (O(1) with cow_snapshot, a copy otherwise), the chunks are searched while writers carry on
+    // - parallel_count(): occurrences, overlapping ones included
+    std::size_t parallel_find(std::string_view needle, std::size_t pos = 0, const ParallelOptions& options = {}) const;
+    std::size_t parallel_count(std::string_view needle, const ParallelOptions& options = {}) const;
+
     // ===== safe convenience =====
-    std::string str() const;
+    std::string str() const;          // copy (made outside the lock with cow_snapshot)
+
+    // immutable snapshot: O(1) under the lock with cow_snapshot (a copy of the string otherwise)
+    // - pointers/views from the Snapshot stay valid while the handle lives, whatever writers do meanwhile
+    Snapshot snapshot() const;
+
+    // zero-copy substrings pinned to a snapshot (one lock acquisition, no allocation with cow_snapshot)
+    // - substr_view(): one substring; throws std::out_of_range like substr()
+    // - views(): the whole value; cut any number of sub-views from it without locking this object again
+    SnapshotView substr_view(std::size_t pos = 0, std::size_t count = std::string::npos) const {
+        return snapshot().substr_view(pos, count);
+    }
+    SnapshotView views() const { return snapshot().substr_view(); }
 
     // run lock scope with lambda: with_lock()/with() (short alias)
     // ⚠️ in debug mode: calling other members of the same object inside with() scope will trigger assert
     template <typename Fn>
-    auto with_lock(Fn&& f) -> decltype(std::forward<Fn>(f)(std::declval<std::string&>())) {
+    auto with_lock(Fn&& f) -> decltype(std::forward<Fn>(f)(std::declval<string_type&>())) {
 #ifndef NDEBUG
         assert_not_reentrant_();               // prevent reentrancy on same thread
         ReentrancyMark _rmk{this};             // mark "this object lock held" during with() lifetime
 #endif
         std::scoped_lock lock(m_);
+        merge_();
+        detach_();
+        CommitOnExit _commit{this};            // republish metadata even if f throws mid-change
         return std::forward<Fn>(f)(s_);
     }
     template <typename Fn>
-    auto with_lock(Fn&& f) const -> decltype(std::forward<Fn>(f)(std::declval<const std::string&>())) {
+    auto with_lock(Fn&& f) const -> decltype(std::forward<Fn>(f)(std::declval<const string_type&>())) {
 #ifndef NDEBUG
         assert_not_reentrant_();
         ReentrancyMark _rmk{this};
 #endif
-        std::scoped_lock lock(m_);
-        return std::forward<Fn>(f)(s_);
+        read_lock_type lock(m_); // shared for a shared LockPolicy
+        merge_();
+        return std::forward<Fn>(f)(cur_());
     }
     template <typename Fn>
-    auto with(Fn&& f) -> decltype(std::forward<Fn>(f)(std::declval<std::string&>())) {
+    auto with(Fn&& f) -> decltype(std::forward<Fn>(f)(std::declval<string_type&>())) {
         return with_lock(std::forward<Fn>(f));
     }
     template <typename Fn>
-    auto with(Fn&& f) const -> decltype(std::forward<Fn>(f)(std::declval<const std::string&>())) {
+    auto with(Fn&& f) const -> decltype(std::forward<Fn>(f)(std::declval<const string_type&>())) {
         return with_lock(std::forward<Fn>(f));
     }
 
+    // non-blocking / bounded variants of with()
+    // - f runs only if the lock was acquired: result in std::optional (true/false when f returns void),
+    //   an empty optional (false) means the lock was busy and f was not called
+    // - with_for()/with_until() use the policy's try_lock_until() when it has one, otherwise they poll
+    //   try_lock() with backoff (spin, yield, then 50us sleeps) until the deadline
+    template <typename Fn>
+    auto try_with(Fn&& f) -> detail::try_result_t<decltype(std::forward<Fn>(f)(std::declval<string_type&>()))> {
+#ifndef NDEBUG
+        assert_not_reentrant_();
+        ReentrancyMark _rmk{this};
+#endif
+        std::unique_lock<LockPolicy> lock(m_, std::try_to_lock);
+        if (!lock.owns_lock()) return {};
+        return call_locked_(std::forward<Fn>(f));
+    }
+    template <typename Fn>
+    auto try_with(Fn&& f) const -> detail::try_result_t<decltype(std::forward<Fn>(f)(std::declval<const string_type&>()))> {
+#ifndef NDEBUG
+        assert_not_reentrant_();
+        ReentrancyMark _rmk{this};
+#endif
+        read_lock_type lock(m_, std::try_to_lock);
+        if (!lock.owns_lock()) return {};
+        return call_locked_(std::forward<Fn>(f));
+    }
+    template <typename Clock, typename Duration, typename Fn>
+    auto with_until(const std::chrono::time_point<Clock, Duration>& deadline, Fn&& f)
+        -> detail::try_result_t<decltype(std::forward<Fn>(f)(std::declval<string_type&>()))> {
+#ifndef NDEBUG
+        assert_not_reentrant_();
+        ReentrancyMark _rmk{this};
+#endif
+        std::unique_lock<LockPolicy> lock(m_, std::defer_lock);
+        if (!lock_until_(lock, deadline)) return {};
+        return call_locked_(std::forward<Fn>(f));
+    }
+    template <typename Clock, typename Duration, typename Fn>
+    auto with_until(const std::chrono::time_point<Clock, Duration>& deadline, Fn&& f) const
+        -> detail::try_result_t<decltype(std::forward<Fn>(f)(std::declval<const string_type&>()))> {
+#ifndef NDEBUG
+        assert_not_reentrant_();
+        ReentrancyMark _rmk{this};
+#endif
+        read_lock_type lock(m_, std::defer_lock);
+        if (!lock_until_(lock, deadline)) return {};
+        return call_locked_(std::forward<Fn>(f));
+    }
+    template <typename Rep, typename Period, typename Fn>
+    auto with_for(const std::chrono::duration<Rep, Period>& timeout, Fn&& f)
+        -> detail::try_result_t<decltype(std::forward<Fn>(f)(std::declval<string_type&>()))> {
+        return with_until(std::chrono::steady_clock::now() + timeout, std::forward<Fn>(f));
+    }
+    template <typename Rep, typename Period, typename Fn>
+    auto with_for(const std::chrono::duration<Rep, Period>& timeout, Fn&& f) const
+        -> detail::try_result_t<decltype(std::forward<Fn>(f)(std::declval<const string_type&>()))> {
+        return with_until(std::chrono::steady_clock::now() + timeout, std::forward<Fn>(f));
+    }
+
+    // ===== change notification (feature::versioned) =====
+    // current version: increases by at least one with every write (lock-free load)
+    template <bool V = versioned, std::enable_if_t<V, int> = 0>
+    std::uint64_t version() const noexcept { return this->version_.load(std::memory_order_acquire); }
+
+    // block until version() != last (returns the new version), or until timeout (returns last)
+    template <bool V = versioned, std::enable_if_t<V, int> = 0>
+    std::uint64_t wait_for_change(std::uint64_t last) const {
+        await_change_(last, std::chrono::steady_clock::time_point::max());
+        return version();
+    }
+    template <typename Rep, typename Period, bool V = versioned, std::enable_if_t<V, int> = 0>
+    std::uint64_t wait_for_change(std::uint64_t last, const std::chrono::duration<Rep, Period>& timeout) const {
+        await_change_(last, deadline_after_(timeout));
+        return version();
+    }
+
+    // block until pred(value) holds; pred runs under the read lock, once now and once per observed change
+    // ⚠️ same rules as with() const: do not call members of this object inside pred
+    template <typename Pred, bool V = versioned, std::enable_if_t<V, int> = 0>
+    void wait_until(Pred pred) const {
+        wait_pred_(pred, std::chrono::steady_clock::time_point::max());
+    }
+    // bounded: false if pred still does not hold when timeout expires
+    template <typename Rep, typename Period, typename Pred, bool V = versioned, std::enable_if_t<V, int> = 0>
+    bool wait_for(const std::chrono::duration<Rep, Period>& timeout, Pred pred) const {
+        return wait_pred_(pred, deadline_after_(timeout));
+    }
+
+    // ===== change listeners (feature::notify) =====
+    // call fn after every write, on options.executor (notification_executor() by default), outside the lock
+    // - events carry the listener's previous and the new version; with options.snapshot also the new value
+    // - fn may use this object freely (it never runs on the writer's stack); keep the Subscription alive
+    template <bool N = notifies, std::enable_if_t<N, int> = 0>
+    Subscription subscribe(ChangeListener fn, SubscribeOptions options = {}) const {
+        return subscribe_(std::move(fn), std::move(options));
+    }
+
     // full API access (including iterators/pointers)
     [[nodiscard]] Locked synchronize();
     [[nodiscard]] Locked synchronize() const;
@@ -224,21 +687,182 @@ public:
     [[nodiscard]] Locked guard() { return synchronize(); }
     [[nodiscard]] Locked guard() const { return synchronize(); }
 
+    // non-blocking guard: check owns_lock() (or operator bool) before use
+    [[nodiscard]] Locked try_guard();
+    [[nodiscard]] Locked try_guard() const;
+
 protected:
     // ⚠ protected: RAII c_str() helper is not exposed externally (prevent misuse)
     CStrGuard c_str() const;
 
+    // current value (lock held): the shared snapshot buffer or pool entry if one is active, s_ otherwise
+    const string_type& cur_() const noexcept {
+        if constexpr (cow_snapshots) {
+            if (this->snap_) return *this->snap_;
+            if (this->pooled_) return *this->pooled_;
+        }
+        return s_;
+    }
+    // before a writer changes s_ (exclusive lock held): bring the value back from the snapshot buffer or pool entry
+    void detach_() const;
+    // exclusive lock held: make snap_ hold the current value, for snapshot() and listener events
+    void share_() const;
+    // before a writer replaces the whole value: the snapshot buffer or pool entry is simply let go
+    void discard_() noexcept {
+        if constexpr (cow_snapshots) {
+            this->snap_.reset();
+            this->pooled_ = nullptr;
+        }
+    }
+
+    // move (both locks held, this empty): take other's value as it is, a shared snapshot buffer or InternPool
+    // entry included, so a move never copies it; the next writer of this object detaches it
+    void adopt_buffer_(BasicMutexString& other) {
+        if constexpr (cow_snapshots) {
+            this->snap_ = std::move(other.snap_);
+            this->pooled_ = std::exchange(other.pooled_, nullptr);
+        }
+        s_ = std::move(other.s_);
+    }
+
+    // exclusive lock held (or constructing): make v the current value
+    void adopt_(const Interned& v) {
+        if constexpr (cow_snapshots) {
+            this->snap_.reset();
+            this->pooled_ = v.get();    // not owned: detach_() and share_() copy it, never keep it past the pool
+            string_type().swap(s_);     // the value lives in the pool now
+        } else {
+            s_.assign(v.view());
+        }
+    }
+
+    // called by every writer after it changed s_, while the exclusive lock is still held
+    void commit_() const noexcept {
+        if constexpr (versioned) bump_version_();
+        if constexpr (mirrors_size) {
+            this->size_.store(cur_().size(), std::memory_order_release);
+            this->capacity_.store(cur_().capacity(), std::memory_order_release);
+        }
+        if constexpr (accounts_memory) {
+            const string_type& v = cur_();
+            this->account_(v.size(), v.capacity(), heap_bytes_(v));
+        }
+        if constexpr (notifies) {
+            if (this->listeners_) notify_();
+        }
+    }
+    // feature::versioned: publish one change and wake parked waiters, if any
+    // (seq_cst pairs with await_change_(): either the waiter sees the new version or the writer sees the waiter)
+    void bump_version_() const noexcept {
+        if constexpr (versioned) {
+            this->version_.fetch_add(1, std::memory_order_seq_cst);
+            if (this->waiters_.load(std::memory_order_seq_cst)) detail::unpark_all(this);
+        }
+    }
+    // park until version_ != last or deadline (time_point::max(): no deadline); true if it changed
+    bool await_change_(std::uint64_t last, std::chrono::steady_clock::time_point deadline) const;
+    // feature::notify: register under the exclusive lock / post the current version to every listener (lock held)
+    Subscription subscribe_(ChangeListener fn, SubscribeOptions options) const;
+    void notify_() const noexcept;
+
+    template <typename Pred>
+    bool wait_pred_(Pred& pred, std::chrono::steady_clock::time_point deadline) const {
+        for (;;) {
+            std::uint64_t seen;
+            {
 #ifndef NDEBUG
-    // debug-only reentrancy check helper/mark
-    static thread_local const MutexString* tls_owner_;
+                assert_not_reentrant_();
+                ReentrancyMark _rmk{this};
+#endif
+                read_lock_type lock(m_);
+                merge_();
+                seen = this->version_.load(std::memory_order_acquire);
+                if (pred(cur_())) return true;
+            }
+            if (!await_change_(seen, deadline)) return false;
+        }
+    }
+    template <typename Rep, typename Period>
+    static std::chrono::steady_clock::time_point deadline_after_(const std::chrono::duration<Rep, Period>& timeout) {
+        using secs = std::chrono::duration<double>;
+        const auto now = std::chrono::steady_clock::now();
+        if (timeout <= timeout.zero()) return now;
+        if (std::chrono::duration_cast<secs>(timeout) >= std::chrono::duration_cast<secs>(std::chrono::steady_clock::time_point::max() - now))
+            return std::chrono::steady_clock::time_point::max();   // "forever" without overflowing the clock
+        return now + std::chrono::ceil<std::chrono::steady_clock::duration>(timeout);
+    }
+
+    static std::size_t heap_bytes_(const string_type& v) noexcept {
+        return v.capacity() > detail::sso_capacity<string_type>() ? v.capacity() + 1 : 0;
+    }
+    struct CommitOnExit {
+        const BasicMutexString* self;
+        ~CommitOnExit() { self->commit_(); }
+    };
+
+    // body of try_with()/with_for()/with_until() once the lock is held
+    template <typename Fn>
+    auto call_locked_(Fn&& f) -> detail::try_result_t<decltype(std::forward<Fn>(f)(std::declval<string_type&>()))> {
+        merge_();
+        detach_();
+        CommitOnExit _commit{this};
+        if constexpr (std::is_void_v<decltype(std::forward<Fn>(f)(s_))>) {
+            std::forward<Fn>(f)(s_);
+            return true;
+        } else {
+            return std::forward<Fn>(f)(s_);
+        }
+    }
+    template <typename Fn>
+    auto call_locked_(Fn&& f) const -> detail::try_result_t<decltype(std::forward<Fn>(f)(std::declval<const string_type&>()))> {
+        merge_();
+        if constexpr (std::is_void_v<decltype(std::forward<Fn>(f)(cur_()))>) {
+            std::forward<Fn>(f)(cur_());
+            return true;
+        } else {
+            return std::forward<Fn>(f)(cur_());
+        }
+    }
+
+    // timed acquisition of a deferred unique_lock/shared_lock on m_
+    template <typename Lock, typename Clock, typename Duration>
+    static bool lock_until_(Lock& lock, const std::chrono::time_point<Clock, Duration>& deadline) {
+        constexpr bool shared = std::is_same_v<Lock, std::shared_lock<LockPolicy>>;
+        if constexpr (shared ? is_shared_timed_lockable_v<LockPolicy> : is_timed_lockable_v<LockPolicy>) {
+            return lock.try_lock_until(deadline);
+        } else {
+            for (unsigned i = 0;; ++i) {
+                if (lock.try_lock()) return true;
+                if (Clock::now() >= deadline) return false;
+                if (i < 64) detail::cpu_relax();
+                else if (i < 128) std::this_thread::yield();
+                else std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+    }
+
+    // flat-combining append path (combines_appends only)
+    void combine_append_(std::string_view s);
+    void combine_append_(std::size_t count, char ch);
+    void combine_(detail::AppendRequest& req);
+    void drain_appends_();
+
+    // sharded append path (shards_appends only); merge_() needs the exclusive lock
+    void shard_append_(std::string_view s);
+    void shard_append_(std::size_t count, char ch);
+    detail::AppendShard* this_shard_();   // the calling thread's shard (the shard set is installed on first use)
+    void merge_() const;
+
+#ifndef NDEBUG
+    // debug-only reentrancy check helper/mark (tls_owner_ is in detail::MutexStringBase)
     void assert_not_reentrant_() const {
         // if already inside this object's lock context in the same thread → no reentrancy
         assert(tls_owner_ != this && "reentrancy detected: do not call ms.* again inside with()/guard() scope. "
                                      "Inside with(), only manipulate the provided std::string(s).");
     }
     struct ReentrancyMark {
-        const MutexString* prev;
-        ReentrancyMark(const MutexString* self) : prev(tls_owner_) {
+        const void* prev;
+        ReentrancyMark(const BasicMutexString* self) : prev(tls_owner_) {
             // even if another object is marked, only prevent reentrancy for the same object
             assert(tls_owner_ != self && "no reentrancy for same object");
             tls_owner_ = self;
@@ -248,12 +872,50 @@ protected:
 #endif
 
     // accessible directly by derived classes
-    std::string        s_;
-    mutable std::mutex m_;
+    // (mutable: const members merge append shards and move the value to or from the snapshot buffer)
+    mutable string_type s_;
+    mutable LockPolicy m_;
 };
 
 // non-member swap (ADL target)
-inline void swap(MutexString& a, MutexString& b) { a.swap(b); }
+template <typename LockPolicy, unsigned Features>
+inline void swap(BasicMutexString<LockPolicy, Features>& a, BasicMutexString<LockPolicy, Features>& b) { a.swap(b); }
+
+// member definitions are in MutexString.cpp (explicitly instantiated for the policies below)
+extern template class BasicMutexString<std::mutex>;
+extern template class BasicMutexString<std::mutex, feature::none>;
+extern template class BasicMutexString<std::mutex, feature::standard | feature::combining_append>;
+extern template class BasicMutexString<std::mutex, feature::sharded_append>;
+extern template class BasicMutexString<std::shared_mutex>;
+extern template class BasicMutexString<SpinLock>;
+extern template class BasicMutexString<NullLock>;
+extern template class BasicMutexString<AdaptiveLock>;
+extern template class BasicMutexString<CompactLock, feature::none>;
+extern template class BasicMutexString<std::mutex, feature::size_mirror | feature::pmr>;
+extern template class BasicMutexString<std::mutex, feature::standard | feature::cache_aligned>;
+extern template class BasicMutexString<std::mutex, feature::standard | feature::notify>;
+#if !defined(J2_MUTEX_STRING_MEMORY_STATS)   // otherwise the same type as MutexString
+extern template class BasicMutexString<std::mutex, feature::standard | feature::memory_stats>;
+#endif
+
+using MutexString          = BasicMutexString<std::mutex>;        // default (jstr)
+using SharedMutexString    = BasicMutexString<std::shared_mutex>;
+using SpinMutexString      = BasicMutexString<SpinLock>;          // very short critical sections
+using AdaptiveMutexString  = BasicMutexString<AdaptiveLock>;      // spin briefly, then park (contended)
+using CompactMutexString   = BasicMutexString<CompactLock, feature::none>;  // smallest object: std::string + 1 byte lock
+using CombiningMutexString = BasicMutexString<std::mutex, feature::standard | feature::combining_append>;  // many appenders
+using ShardedMutexString   = BasicMutexString<std::mutex, feature::sharded_append>;  // append-mostly accumulators
+using AlignedMutexString   = BasicMutexString<std::mutex, feature::standard | feature::cache_aligned>;  // arrays/struct members hit by different threads
+using AccountedMutexString = BasicMutexString<std::mutex, feature::standard | feature::memory_stats>;  // jstr + memory accounting
+using ObservableMutexString = BasicMutexString<std::mutex, feature::standard | feature::notify>;  // jstr + change listeners
+using PmrMutexString       = BasicMutexString<std::mutex, feature::size_mirror | feature::pmr>;  // arena/pool-backed values
+using UnsyncMutexString    = BasicMutexString<NullLock>;          // single-thread use, no locking
+
+// CompactMutexString must stay one word larger than std::string (40 bytes with libstdc++/MSVC release)
+static_assert(sizeof(CompactMutexString) <= sizeof(std::string) + sizeof(void*),
+              "CompactMutexString must not grow beyond std::string plus one word");
+static_assert(alignof(AlignedMutexString) == detail::kCacheLine && sizeof(AlignedMutexString) % detail::kCacheLine == 0,
+              "AlignedMutexString must occupy whole cache lines");
 
 } // namespace j2
 
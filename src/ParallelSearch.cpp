@@ -0,0 +1,170 @@
+#include "ParallelSearch.hpp"
+#include "StringSearch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace j2 {
+
+namespace {
+
+constexpr std::size_t npos = std::string_view::npos;
+
+// chunks of one call: claimed by index by the caller and the helpers it posted
+// - shared with the helpers, so one that starts after the call returned only finds nothing left to claim
+struct Job {
+    const std::function<void(std::size_t)>* body = nullptr;   // used only for claimed chunks (< chunks)
+    std::size_t chunks = 0;
+    std::atomic<std::size_t> next{0};
+    std::size_t remaining = 0;   // chunks not finished yet (m)
+    std::mutex m;
+    std::condition_variable cv;
+
+    void work() {
+        for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < chunks;) {
+            (*body)(i);
+            std::scoped_lock lock(m);
+            if (--remaining == 0) cv.notify_all();
+        }
+    }
+};
+
+// worker threads behind parallel_find()/parallel_count()
+class SearchPool {
+public:
+    // starts workers up to n, but never more than one per core but the caller's (they live until the process
+    // exits); returns how many there are
+    std::size_t reserve(std::size_t n) {
+        n = std::min<std::size_t>(n, std::max(1u, std::thread::hardware_concurrency()) - 1);
+        std::scoped_lock lock(m_);
+        try {
+            for (; workers_ < n; ++workers_) std::thread([this] { run_(); }).detach();
+        } catch (...) {
+            // no more threads: search with the ones we have
+        }
+        return workers_;
+    }
+
+    void post(std::shared_ptr<Job> job) {
+        {
+            std::scoped_lock lock(m_);
+            q_.push_back(std::move(job));
+        }
+        cv_.notify_one();
+    }
+
+private:
+    void run_() {
+        std::unique_lock lock(m_);
+        for (;;) {
+            cv_.wait(lock, [this] { return !q_.empty(); });
+            std::shared_ptr<Job> job = std::move(q_.front());
+            q_.pop_front();
+            lock.unlock();
+            job->work();
+            job.reset();
+            lock.lock();
+        }
+    }
+
+    std::mutex m_;
+    std::condition_variable cv_;
+    std::deque<std::shared_ptr<Job>> q_;
+    std::size_t workers_ = 0;
+};
+
+SearchPool& search_pool() {
+    static SearchPool* p = new SearchPool;   // leaked: detached workers may still wait on it during exit
+    return *p;
+}
+
+// runs body(0) .. body(chunks - 1) on up to `threads` threads, the caller included
+// (past the pool's size the extra chunks wait for a thread that is already searching)
+void run_chunks(std::size_t chunks, unsigned threads, const std::function<void(std::size_t)>& body) {
+    auto job = std::make_shared<Job>();
+    job->body = &body;
+    job->chunks = chunks;
+    job->remaining = chunks;
+    SearchPool& pool = search_pool();
+    const std::size_t helpers = std::min(pool.reserve(threads - 1), chunks - 1);
+    for (std::size_t i = 0; i < helpers; ++i) {
+        try {
+            pool.post(job);
+        } catch (...) {
+            break;   // not posted: the caller claims those chunks itself
+        }
+    }
+    job->work();
+    std::unique_lock lock(job->m);
+    job->cv.wait(lock, [&] { return job->remaining == 0; });
+}
+
+struct Split {
+    std::size_t chunk;    // candidate positions per chunk
+    std::size_t chunks;
+    unsigned threads;
+};
+
+Split split(std::size_t starts, const ParallelOptions& options) {
+    const unsigned threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t min_chunk = std::max<std::size_t>(options.min_chunk, 1);
+    if (threads <= 1 || starts / 2 < min_chunk) return {starts, 1, 1};
+    // a few chunks per thread: uneven progress evens out, and find() stops sooner after a match
+    const std::size_t chunk = std::max(min_chunk, (starts + threads * std::size_t{4} - 1) / (threads * std::size_t{4}));
+    return {chunk, (starts + chunk - 1) / chunk, threads};
+}
+
+} // namespace
+
+std::size_t parallel_find(std::string_view text, std::string_view needle, std::size_t pos, const ParallelOptions& options) {
+    if (pos > text.size() || needle.size() > text.size() - pos) return npos;
+    if (needle.empty()) return pos;
+    const std::size_t m = needle.size();
+    const std::size_t starts = text.size() - pos - m + 1;   // candidate positions pos .. pos + starts - 1
+    const Split sp = split(starts, options);
+    if (sp.chunks == 1) return detail::fast_find(text, needle, pos);
+
+    std::atomic<std::size_t> first{npos};
+    run_chunks(sp.chunks, sp.threads, [&](std::size_t i) {
+        const std::size_t begin = pos + i * sp.chunk;
+        if (begin > first.load(std::memory_order_relaxed)) return;   // an earlier chunk already matched
+        const std::size_t n = std::min(sp.chunk, pos + starts - begin);
+        const std::size_t at = detail::fast_find(text.substr(begin, n + m - 1), needle, 0);
+        if (at == npos) return;
+        std::size_t cur = first.load(std::memory_order_relaxed);
+        while (begin + at < cur && !first.compare_exchange_weak(cur, begin + at, std::memory_order_relaxed)) {}
+    });
+    return first.load(std::memory_order_relaxed);
+}
+
+std::size_t parallel_count(std::string_view text, std::string_view needle, const ParallelOptions& options) {
+    if (needle.empty()) return text.size() + 1;
+    if (needle.size() > text.size()) return 0;
+    const std::size_t m = needle.size();
+    const std::size_t starts = text.size() - m + 1;
+    // occurrences starting in [begin, begin + n)
+    auto count_in = [&](std::size_t begin, std::size_t n) {
+        const std::string_view part = text.substr(begin, n + m - 1);
+        std::size_t c = 0;
+        for (std::size_t at = detail::fast_find(part, needle, 0); at != npos; at = detail::fast_find(part, needle, at + 1)) ++c;
+        return c;
+    };
+    const Split sp = split(starts, options);
+    if (sp.chunks == 1) return count_in(0, starts);
+
+    std::atomic<std::size_t> total{0};
+    run_chunks(sp.chunks, sp.threads, [&](std::size_t i) {
+        const std::size_t begin = i * sp.chunk;
+        total.fetch_add(count_in(begin, std::min(sp.chunk, starts - begin)), std::memory_order_relaxed);
+    });
+    return total.load(std::memory_order_relaxed);
+}
+
+} // namespace j2
@@ -0,0 +1,29 @@
+#pragma once
+#include <string_view>
+#include <cstddef>
+
+// j2 namespace
+namespace j2 {
+
+// how parallel_find()/parallel_count() split the work
+struct ParallelOptions {
+    unsigned threads = 0;                          // threads searching at once, the caller included (0: all cores;
+                                                   // more than the cores only cuts more chunks, the pool does not grow)
+    std::size_t min_chunk = std::size_t{1} << 20;  // bytes per task; shorter texts are searched on the calling thread
+};
+
+// substring search over a large text on a shared thread pool
+// - the text is cut into chunks of candidate positions; each chunk is searched with the find() kernels over its
+//   own range plus needle.size() - 1 bytes of the next one, so occurrences across chunk borders are found once
+// - the pool (at most one worker per core but the caller's) starts on first use and lives until the process exits;
+//   the calling thread searches chunks too and returns when every chunk is done
+// - the text must stay valid and unchanged during the call: search a Snapshot, not a value under a lock
+
+// first occurrence at or after pos, like std::string_view::find (chunks past a match are skipped)
+std::size_t parallel_find(std::string_view text, std::string_view needle, std::size_t pos = 0,
+                          const ParallelOptions& options = {});
+// number of occurrences, overlapping ones included ("aa" occurs 3 times in "aaaa");
+// an empty needle matches at every position (text.size() + 1)
+std::size_t parallel_count(std::string_view text, std::string_view needle, const ParallelOptions& options = {});
+
+} // namespace j2
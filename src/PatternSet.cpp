@@ -0,0 +1,126 @@
+#include "PatternSet.hpp"
+
+#include <stdexcept>
+
+namespace j2 {
+
+// ================= construction =================
+void PatternSet::add_(std::string_view p) {
+    if (p.empty()) throw std::invalid_argument("PatternSet: empty pattern");
+    patterns_.emplace_back(p);
+}
+
+void PatternSet::compile_() {
+    // 1) columns: one per distinct byte used by a pattern, column 0 for all the others
+    for (const std::string& p : patterns_) {
+        for (char c : p) {
+            std::uint16_t& col = column_[static_cast<unsigned char>(c)];
+            if (!col) col = static_cast<std::uint16_t>(columns_++);
+        }
+    }
+    const std::size_t w = columns_;
+
+    // 2) trie (0 in next_ means "no edge": no edge leads back to the root)
+    next_.assign(w, 0);
+    term_.assign(1, kNone);
+    same_.assign(patterns_.size(), kNone);
+    for (std::size_t i = 0; i < patterns_.size(); ++i) {
+        std::uint32_t s = 0;
+        for (char c : patterns_[i]) {
+            const std::size_t col = column_[static_cast<unsigned char>(c)];
+            if (!next_[s * w + col]) {
+                next_[s * w + col] = static_cast<std::uint32_t>(term_.size());
+                next_.resize(next_.size() + w, 0);
+                term_.push_back(kNone);
+            }
+            s = next_[s * w + col];
+        }
+        // equal patterns share the end state: chain them, keeping construction order
+        if (term_[s] == kNone) {
+            term_[s] = static_cast<std::uint32_t>(i);
+        } else {
+            std::uint32_t p = term_[s];
+            while (same_[p] != kNone) p = same_[p];
+            same_[p] = static_cast<std::uint32_t>(i);
+        }
+    }
+
+    // 3) breadth-first: failure links folded into the table, so every state has an edge for every column
+    std::vector<std::uint32_t> fail(term_.size(), 0), queue;
+    dict_.assign(term_.size(), kNone);
+    queue.reserve(term_.size());
+    for (std::size_t col = 0; col < w; ++col) {
+        if (const std::uint32_t t = next_[col]) queue.push_back(t);   // depth 1: fail to the root
+    }
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        const std::uint32_t s = queue[head];
+        const std::uint32_t f = fail[s];
+        dict_[s] = term_[f] != kNone ? f : dict_[f];
+        for (std::size_t col = 0; col < w; ++col) {
+            std::uint32_t& t = next_[s * w + col];
+            if (t) {
+                fail[t] = next_[f * w + col];
+                queue.push_back(t);
+            } else {
+                t = next_[f * w + col];
+            }
+        }
+    }
+
+    // 4) entries hold the target's row offset (no multiply in the scan) and kOutput when a pattern ends there
+    if (term_.size() * w > kRow) throw std::length_error("PatternSet: too many states");
+    for (std::uint32_t& t : next_) {
+        t = static_cast<std::uint32_t>(t * w) | (term_[t] != kNone || dict_[t] != kNone ? kOutput : 0);
+    }
+}
+
+// ================= search =================
+template <typename Emit>
+void PatternSet::scan_(std::string_view text, std::size_t pos, Emit&& emit) const {
+    if (patterns_.empty() || pos >= text.size()) return;
+    const std::size_t w = columns_;
+    const std::uint32_t* next = next_.data();
+    std::uint32_t row = 0;   // the automaton starts at pos, so no match can start before it
+    for (std::size_t i = pos; i < text.size(); ++i) {
+        const std::uint32_t e = next[row + column_[static_cast<unsigned char>(text[i])]];
+        row = e & kRow;
+        if (!(e & kOutput)) continue;
+        // patterns ending at i: this state, then shorter suffixes through dict_ (longest first)
+        const std::uint32_t s = static_cast<std::uint32_t>(row / w);
+        for (std::uint32_t u = term_[s] != kNone ? s : dict_[s]; u != kNone; u = dict_[u]) {
+            for (std::uint32_t p = term_[u]; p != kNone; p = same_[p]) {
+                const std::size_t len = patterns_[p].size();
+                if (!emit(PatternMatch{i + 1 - len, len, p})) return;
+            }
+        }
+    }
+}
+
+std::optional<PatternMatch> PatternSet::find_any(std::string_view text, std::size_t pos) const noexcept {
+    std::optional<PatternMatch> hit;
+    scan_(text, pos, [&](const PatternMatch& m) {
+        hit = m;
+        return false;
+    });
+    return hit;
+}
+
+std::vector<PatternMatch> PatternSet::find_all(std::string_view text, std::size_t pos) const {
+    std::vector<PatternMatch> out;
+    scan_(text, pos, [&](const PatternMatch& m) {
+        out.push_back(m);
+        return true;
+    });
+    return out;
+}
+
+std::size_t PatternSet::count(std::string_view text, std::size_t pos) const noexcept {
+    std::size_t n = 0;
+    scan_(text, pos, [&](const PatternMatch&) {
+        ++n;
+        return true;
+    });
+    return n;
+}
+
+} // namespace j2
@@ -0,0 +1,83 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <initializer_list>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+
+// j2 namespace
+namespace j2 {
+
+// one occurrence found by a PatternSet
+struct PatternMatch {
+    std::size_t offset = 0;    // start of the occurrence in the searched text
+    std::size_t length = 0;
+    std::size_t pattern = 0;   // index of the pattern in the set (construction order)
+
+    friend bool operator==(const PatternMatch& a, const PatternMatch& b) {
+        return a.offset == b.offset && a.length == b.length && a.pattern == b.pattern;
+    }
+    friend bool operator!=(const PatternMatch& a, const PatternMatch& b) { return !(a == b); }
+};
+
+// compiled set of keywords, searched all at once (Aho-Corasick automaton)
+// - one pass over the text finds every occurrence of every pattern: O(text + matches), whatever the
+//   number of patterns, instead of one find() (and one lock acquisition) per keyword
+// - compiled into a complete transition table over the bytes that occur in the patterns (every other
+//   byte shares one column), so the scan is one table load per byte and never follows failure links
+// - an automaton larger than 2^31 table entries (states × distinct bytes) throws std::length_error
+// - immutable after construction: share one set between threads freely
+// - patterns are case-sensitive byte strings; an empty pattern throws std::invalid_argument
+class PatternSet {
+public:
+    PatternSet() = default;   // matches nothing
+    PatternSet(std::initializer_list<std::string_view> patterns) { build_(patterns.begin(), patterns.end()); }
+    // any range of string-like values (std::vector<std::string>, std::array<const char*, N>, ...)
+    template <typename Range, typename = decltype(std::string_view(*std::begin(std::declval<const Range&>())))>
+    explicit PatternSet(const Range& patterns) { build_(std::begin(patterns), std::end(patterns)); }
+
+    std::size_t size() const noexcept { return patterns_.size(); }
+    bool empty() const noexcept { return patterns_.empty(); }
+    std::string_view pattern(std::size_t i) const { return patterns_.at(i); }
+    std::size_t states() const noexcept { return term_.size(); }   // automaton size (memory: states() * columns)
+
+    // ===== search =====
+    // the occurrence that ends first (the longest one if several end at the same byte), starting at or after pos
+    std::optional<PatternMatch> find_any(std::string_view text, std::size_t pos = 0) const noexcept;
+    // every occurrence starting at or after pos, overlapping ones included, ordered by end position
+    // (longest first among those ending at the same byte)
+    std::vector<PatternMatch> find_all(std::string_view text, std::size_t pos = 0) const;
+    // number of occurrences (same as find_all().size(), without building the vector)
+    std::size_t count(std::string_view text, std::size_t pos = 0) const noexcept;
+
+private:
+    static constexpr std::uint32_t kNone = ~std::uint32_t{0};
+    static constexpr std::uint32_t kOutput = std::uint32_t{1} << 31;   // next_ entry: a pattern ends in the target
+    static constexpr std::uint32_t kRow = kOutput - 1;                  // next_ entry: row offset of the target
+
+    template <typename It>
+    void build_(It first, It last) {
+        for (; first != last; ++first) add_(std::string_view(*first));
+        compile_();
+    }
+    void add_(std::string_view p);
+    void compile_();
+
+    // calls emit(PatternMatch) for every occurrence until it returns false
+    template <typename Emit>
+    void scan_(std::string_view text, std::size_t pos, Emit&& emit) const;
+
+    std::vector<std::string> patterns_;
+    std::uint16_t column_[256] = {};       // byte → column of the transition table (0: byte in no pattern)
+    std::uint32_t columns_ = 1;
+    std::vector<std::uint32_t> next_;      // states × columns: complete transition function (see compile_)
+    std::vector<std::uint32_t> term_;      // per state: a pattern ending exactly here, or kNone
+    std::vector<std::uint32_t> dict_;      // per state: nearest proper suffix state with a term_, or kNone
+    std::vector<std::uint32_t> same_;      // per pattern: next pattern equal to it, or kNone
+};
+
+} // namespace j2
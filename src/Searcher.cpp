@@ -0,0 +1,67 @@
+#include "Searcher.hpp"
+
+#include <array>
+#include <cstdint>
+
+namespace j2 {
+
+namespace {
+
+// how common a byte is in text, logs and URLs (higher: more common); bytes not listed rank 0
+constexpr std::array<std::uint8_t, 256> make_byte_ranks() noexcept {
+    constexpr std::string_view by_frequency =
+        " etao/insrhl.dcu0m1fp2g-w_y3b4v5:6k7=8x9,j&q?z\n\"ETAOINSRHLDCUMFPGWYBVKXJQZ()';<>[]{}#@!%+*|\\^$~`\t\r";
+    std::array<std::uint8_t, 256> rank{};
+    for (std::size_t i = 0; i < by_frequency.size(); ++i) {
+        rank[static_cast<unsigned char>(by_frequency[i])] = static_cast<std::uint8_t>(by_frequency.size() - i);
+    }
+    return rank;
+}
+constexpr std::array<std::uint8_t, 256> kByteRank = make_byte_ranks();
+
+// offsets of the rarest needle byte and of the rarest one that differs from it (two equal filter bytes
+// filter no better than one); rank(c): how common c is
+template <typename Rank>
+void pick_rare(std::string_view needle, Rank rank, std::size_t& rare1, std::size_t& rare2) {
+    const std::size_t k = needle.size();
+    rare1 = 0;
+    rare2 = 0;
+    if (k < 2) return;
+    for (std::size_t i = 1; i < k; ++i) {
+        if (rank(needle[i]) < rank(needle[rare1])) rare1 = i;
+    }
+    rare2 = rare1 == k - 1 ? 0 : k - 1;
+    bool distinct = false;
+    for (std::size_t i = 0; i < k; ++i) {
+        if (needle[i] == needle[rare1]) continue;
+        if (!distinct || rank(needle[i]) < rank(needle[rare2])) rare2 = i;
+        distinct = true;
+    }
+}
+
+} // namespace
+
+Searcher::Searcher(std::string_view needle)
+    : needle_(needle)
+    , kernels_(&detail::search_kernels())
+{
+    pick_rare(needle_, [](char c) { return kByteRank[static_cast<unsigned char>(c)]; }, rare1_, rare2_);
+}
+
+Searcher::Searcher(std::string_view needle, std::string_view sample)
+    : needle_(needle)
+    , kernels_(&detail::search_kernels())
+{
+    std::size_t seen[256] = {};
+    for (char c : sample) ++seen[static_cast<unsigned char>(c)];
+    pick_rare(needle_, [&](char c) { return seen[static_cast<unsigned char>(c)]; }, rare1_, rare2_);
+}
+
+std::size_t Searcher::count(std::string_view text, std::size_t pos) const noexcept {
+    if (needle_.empty()) return pos <= text.size() ? text.size() - pos + 1 : 0;
+    std::size_t n = 0;
+    for (std::size_t at = find(text, pos); at != std::string_view::npos; at = find(text, at + 1)) ++n;
+    return n;
+}
+
+} // namespace j2
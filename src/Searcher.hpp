@@ -0,0 +1,40 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+#include "StringSearch.hpp"
+
+// j2 namespace
+namespace j2 {
+
+// needle analyzed once, for find()/count() repeated over many texts (ms.find(searcher), routing tables, ...)
+// - the vector kernels filter candidates on two needle bytes; find(needle) always uses the first and the
+//   last one, a Searcher uses the two rarest ones (by a fixed ranking of byte frequency in text and URLs, or
+//   by the frequencies in a sample of the texts to search), so fewer false candidates reach memcmp:
+//   "/api/users/" filters on 'p' and 'u', not on '/' twice
+// - a heuristic: bytes that are rare alone but always appear together filter like one byte (measure)
+// - the kernel set is resolved once; immutable after construction: share one between threads freely
+class Searcher {
+public:
+    explicit Searcher(std::string_view needle);
+    // byte frequencies counted in a sample of the texts to search, instead of the built-in ranking
+    Searcher(std::string_view needle, std::string_view sample);
+
+    std::string_view needle() const noexcept { return needle_; }
+    std::size_t size() const noexcept { return needle_.size(); }
+
+    // first occurrence at or after pos, like std::string_view::find
+    std::size_t find(std::string_view text, std::size_t pos = 0) const noexcept {
+        return kernels_->find_pair(text, needle_, rare1_, rare2_, pos);
+    }
+    // occurrences starting at or after pos, overlapping ones included (like parallel_count())
+    std::size_t count(std::string_view text, std::size_t pos = 0) const noexcept;
+
+private:
+    std::string needle_;
+    std::size_t rare1_ = 0, rare2_ = 0;   // offsets of the filter bytes
+    const detail::SearchKernels* kernels_;
+};
+
+} // namespace j2
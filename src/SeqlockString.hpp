@@ -0,0 +1,305 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <utility>
+
+#include "LockPolicy.hpp"
+
+// j2 namespace
+namespace j2 {
+
+// bounded thread-safe string with seqlock (optimistic) reads
+// - readers never write shared memory: they copy what they need, then re-check the sequence number
+//   and retry if a writer was active → no lock, no cache-line bouncing between reader cores
+// - writers serialize on LockPolicy and bump the sequence number around every mutation (odd = writing)
+// - contents are stored in-object (at most Capacity chars): a std::string heap buffer could be freed
+//   under an optimistic reader, an in-object array cannot
+// - storage is an array of relaxed atomic words, so the racing reads are well-defined
+// - growing beyond Capacity throws std::length_error (max_size() == Capacity)
+// - no guard()/pointer access: every read returns a value or a validated copy
+template <std::size_t Capacity, typename LockPolicy = std::mutex>
+class SeqlockString {
+    static_assert(Capacity > 0, "SeqlockString needs a non-zero capacity");
+
+public:
+    using lock_type = LockPolicy;
+    static constexpr std::size_t npos = std::string::npos;
+
+    // ===== constructors/assignments =====
+    SeqlockString() = default;
+    SeqlockString(std::string_view s) { assign(s); }
+    SeqlockString(const char* s) { assign(s); }
+    SeqlockString(const SeqlockString& other) { Image img; other.load_(img); assign(img.view()); }
+    SeqlockString& operator=(const SeqlockString& other) {
+        if (this != &other) { Image img; other.load_(img); assign(img.view()); }
+        return *this;
+    }
+
+    SeqlockString& operator=(std::string_view rhs) { assign(rhs); return *this; }
+    SeqlockString& operator=(const char* rhs) { assign(rhs); return *this; }
+
+    // ===== comparison (optimistic read) =====
+    bool operator==(std::string_view rhs) const { return compare(rhs) == 0; }
+    bool operator==(const char* rhs) const { return compare(rhs ? rhs : "") == 0; }
+    bool operator!=(std::string_view rhs) const { return !(*this == rhs); }
+    bool operator!=(const char* rhs) const { return !(*this == rhs); }
+    friend inline bool operator==(std::string_view lhs, const SeqlockString& rhs) { return rhs == lhs; }
+    friend inline bool operator==(const char* lhs, const SeqlockString& rhs) { return rhs == lhs; }
+    friend inline bool operator!=(std::string_view lhs, const SeqlockString& rhs) { return !(rhs == lhs); }
+    friend inline bool operator!=(const char* lhs, const SeqlockString& rhs) { return !(rhs == lhs); }
+
+    int compare(std::string_view s) const {
+        Image img; load_(img);
+        return img.view().compare(s);
+    }
+
+    // ===== capacity/status (optimistic read) =====
+    std::size_t size() const { return read_([&]{ return len_.load(std::memory_order_relaxed); }); }
+    std::size_t length() const { return size(); }
+    bool empty() const { return size() == 0; }
+    static constexpr std::size_t capacity() { return Capacity; }
+    static constexpr std::size_t max_size() { return Capacity; }
+
+    // ===== element access (optimistic read, value return) + setters =====
+    char at(std::size_t pos) const {
+        std::size_t n = 0;
+        char ch = read_([&]{ n = len_.load(std::memory_order_relaxed); return pos < n ? char_(pos) : '\0'; });
+        if (pos >= n) throw std::out_of_range("SeqlockString::at");
+        return ch;
+    }
+    char operator[](std::size_t pos) const {   // pos == size() yields '\0' like std::string
+        return read_([&]{ return pos < len_.load(std::memory_order_relaxed) ? char_(pos) : '\0'; });
+    }
+    char front() const { return (*this)[0]; }
+    char back() const {
+        return read_([&]{
+            std::size_t n = len_.load(std::memory_order_relaxed);
+            return n ? char_(std::min(n, Capacity) - 1) : '\0';
+        });
+    }
+
+    void set(std::size_t pos, char ch) {
+        write_([&](Image& img) {
+            if (pos >= img.len) throw std::out_of_range("SeqlockString::set");
+            img.data[pos] = ch;
+            return pos;
+        });
+    }
+    void front(char ch) { set(0, ch); }
+    void back(char ch) {
+        write_([&](Image& img) {
+            if (img.len == 0) throw std::out_of_range("SeqlockString::back");
+            img.data[img.len - 1] = ch;
+            return img.len - 1;
+        });
+    }
+
+    // ===== modifiers (locked, version bumped around the mutation) =====
+    void clear() { write_([](Image& img) { img.len = 0; return std::size_t{0}; }); }
+    void push_back(char ch) { append(1, ch); }
+    void pop_back() {
+        write_([](Image& img) {
+            if (img.len == 0) throw std::out_of_range("SeqlockString::pop_back");
+            return --img.len;
+        });
+    }
+
+    void assign(std::string_view s) { replace_all_(s); }
+    void assign(const char* s) { replace_all_(s ? std::string_view(s) : std::string_view()); }
+    void assign(std::size_t count, char ch) {
+        write_([&](Image& img) {
+            check_length_(count);
+            std::memset(img.data, ch, count);
+            img.len = count;
+            return std::size_t{0};
+        });
+    }
+
+    SeqlockString& append(std::string_view s) { return replace(npos, 0, s); }
+    SeqlockString& append(const char* s) { return append(s ? std::string_view(s) : std::string_view()); }
+    SeqlockString& append(std::size_t count, char ch) {
+        write_([&](Image& img) {
+            check_length_(img.len + count);
+            std::memset(img.data + img.len, ch, count);
+            std::size_t from = img.len;
+            img.len += count;
+            return from;
+        });
+        return *this;
+    }
+
+    SeqlockString& operator+=(std::string_view s) { return append(s); }
+    SeqlockString& operator+=(const char* s) { return append(s); }
+    SeqlockString& operator+=(char ch) { return append(1, ch); }
+
+    SeqlockString& insert(std::size_t pos, std::string_view s) {
+        write_([&](Image& img) {
+            if (pos > img.len) throw std::out_of_range("SeqlockString::insert");
+            return img.splice(pos, 0, s);
+        });
+        return *this;
+    }
+    SeqlockString& insert(std::size_t pos, const char* s) { return insert(pos, s ? std::string_view(s) : std::string_view()); }
+
+    SeqlockString& erase(std::size_t pos = 0, std::size_t count = npos) {
+        write_([&](Image& img) {
+            if (pos > img.len) throw std::out_of_range("SeqlockString::erase");
+            return img.splice(pos, count, std::string_view());
+        });
+        return *this;
+    }
+
+    // pos == npos appends
+    SeqlockString& replace(std::size_t pos, std::size_t count, std::string_view s) {
+        write_([&](Image& img) {
+            std::size_t at = pos == npos ? img.len : pos;
+            if (at > img.len) throw std::out_of_range("SeqlockString::replace");
+            return img.splice(at, count, s);
+        });
+        return *this;
+    }
+    SeqlockString& replace(std::size_t pos, std::size_t count, const char* s) {
+        return replace(pos, count, s ? std::string_view(s) : std::string_view());
+    }
+
+    void resize(std::size_t n, char ch = '\0') {
+        write_([&](Image& img) {
+            check_length_(n);
+            std::size_t from = std::min(img.len, n);
+            if (n > img.len) std::memset(img.data + img.len, ch, n - img.len);
+            img.len = n;
+            return from;
+        });
+    }
+
+    // ===== string operations (optimistic read into a local copy) =====
+    std::string substr(std::size_t pos = 0, std::size_t count = npos) const {
+        Image img; load_(img);
+        return std::string(img.view().substr(pos, count));   // throws out_of_range like std::string
+    }
+    std::size_t copy(char* dest, std::size_t count, std::size_t pos = 0) const {
+        Image img; load_(img);
+        return img.view().copy(dest, count, pos);
+    }
+
+    // ===== safe convenience =====
+    std::string str() const { Image img; load_(img); return std::string(img.view()); }
+
+    // run f on a consistent copy (std::string_view valid only inside f); no lock is held while f runs
+    template <typename Fn>
+    auto with(Fn&& f) const -> decltype(std::forward<Fn>(f)(std::declval<std::string_view>())) {
+        Image img; load_(img);
+        return std::forward<Fn>(f)(img.view());
+    }
+
+    // current sequence number (even = stable); changes on every mutation
+    std::uint64_t version() const { return seq_.load(std::memory_order_acquire); }
+
+protected:
+    static constexpr std::size_t kWord  = sizeof(std::uint64_t);
+    static constexpr std::size_t kWords = (Capacity + kWord - 1) / kWord;
+
+    // plain local copy used by readers (after validation) and writers (under the lock)
+    struct Image {
+        std::size_t len = 0;
+        char data[kWords * kWord];
+
+        std::string_view view() const { return std::string_view(data, len); }
+
+        // replace [pos, pos+count) with s, return first changed position
+        std::size_t splice(std::size_t pos, std::size_t count, std::string_view s) {
+            count = std::min(count, len - pos);
+            check_length_(len - count + s.size());
+            std::memmove(data + pos + s.size(), data + pos + count, len - pos - count);
+            if (!s.empty()) std::memcpy(data + pos, s.data(), s.size());   // erase() passes a null view
+            len = len - count + s.size();
+            return pos;
+        }
+    };
+
+    // throws like std::string when the result would exceed max_size()
+    static void check_length_(std::size_t n) {
+        if (n > Capacity) throw std::length_error("SeqlockString: capacity exceeded");
+    }
+
+    char char_(std::size_t pos) const {
+        std::uint64_t w = words_[pos / kWord].load(std::memory_order_relaxed);
+        char bytes[kWord];
+        std::memcpy(bytes, &w, kWord);
+        return bytes[pos % kWord];
+    }
+
+    // seqlock read: f only performs relaxed loads; its result is returned once the sequence is unchanged
+    template <typename Fn>
+    auto read_(Fn&& f) const -> decltype(f()) {
+        for (;;) {
+            std::uint64_t s1 = seq_.load(std::memory_order_acquire);
+            if (s1 & 1) { detail::cpu_relax(); continue; }  // writer active
+            auto r = f();
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq_.load(std::memory_order_relaxed) == s1) return r;
+        }
+    }
+
+    // validated copy of the whole contents
+    void load_(Image& img) const {
+        read_([&]{
+            img.len = std::min(len_.load(std::memory_order_relaxed), Capacity);
+            copy_words_(img, img.len);
+            return 0;
+        });
+    }
+
+    void copy_words_(Image& img, std::size_t n) const {
+        for (std::size_t i = 0, w = (n + kWord - 1) / kWord; i < w; ++i) {
+            std::uint64_t v = words_[i].load(std::memory_order_relaxed);
+            std::memcpy(img.data + i * kWord, &v, kWord);
+        }
+    }
+
+    // writer: lock, mutate a local image, publish from the first changed position
+    template <typename Fn>
+    void write_(Fn&& mutate) {
+        std::scoped_lock lock(m_);
+        Image img;
+        img.len = len_.load(std::memory_order_relaxed);   // no other writer: plain loads are stable
+        copy_words_(img, img.len);
+        std::size_t from = mutate(img);                   // may throw before anything is published
+        publish_(img, from);
+    }
+
+    void replace_all_(std::string_view s) {
+        check_length_(s.size());
+        std::scoped_lock lock(m_);
+        Image img;
+        if (!s.empty()) std::memcpy(img.data, s.data(), s.size());   // memcpy from null is UB even for 0 bytes
+        img.len = s.size();
+        publish_(img, 0);
+    }
+
+    void publish_(const Image& img, std::size_t from) {
+        std::uint64_t s = seq_.load(std::memory_order_relaxed);
+        seq_.store(s + 1, std::memory_order_relaxed);      // odd: readers will retry
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = from / kWord, w = (img.len + kWord - 1) / kWord; i < w; ++i) {
+            std::uint64_t v;
+            std::memcpy(&v, img.data + i * kWord, kWord);
+            words_[i].store(v, std::memory_order_relaxed);
+        }
+        len_.store(img.len, std::memory_order_relaxed);
+        seq_.store(s + 2, std::memory_order_release);      // even: stable again
+    }
+
+    std::atomic<std::uint64_t> seq_{0};
+    std::atomic<std::size_t>   len_{0};
+    std::atomic<std::uint64_t> words_[kWords] = {};
+    LockPolicy                 m_;     // writers only
+};
+
+} // namespace j2
@@ -0,0 +1,108 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <memory>
+#include <utility>
+#include <cstddef>
+
+// j2 namespace
+namespace j2 {
+
+class SnapshotView;
+
+// immutable, reference-counted string snapshot
+// - copying a Snapshot only bumps a reference count (no buffer copy)
+// - the referenced string never changes; writers of the source publish a new buffer instead
+// - pointers/views obtained from a Snapshot stay valid while the handle (or a copy of it) is alive
+class Snapshot {
+public:
+    Snapshot() = default;                        // empty string
+    explicit Snapshot(std::shared_ptr<const std::string> p) : p_(std::move(p)) {}
+
+    const std::string& str() const { return p_ ? *p_ : empty_(); }
+    operator const std::string&() const { return str(); }   // "std::string s = snap;" copies explicitly
+    operator std::string_view() const { return str(); }
+    std::string_view view() const { return str(); }
+
+    const char* c_str() const { return str().c_str(); }
+    const char* data() const { return str().data(); }
+    std::size_t size() const { return str().size(); }
+    std::size_t length() const { return str().size(); }
+    bool empty() const { return str().empty(); }
+    char operator[](std::size_t pos) const { return str()[pos]; }
+
+    // zero-copy substrings: the returned view keeps this buffer alive (throws std::out_of_range like substr)
+    SnapshotView substr_view(std::size_t pos = 0, std::size_t count = std::string::npos) const;
+
+    // true when both handles share one buffer (O(1), no character comparison)
+    bool same_buffer(const Snapshot& other) const { return p_ == other.p_; }
+
+    // underlying shared pointer (for APIs that want std::shared_ptr)
+    const std::shared_ptr<const std::string>& get() const { return p_; }
+
+    friend bool operator==(const Snapshot& a, const Snapshot& b) { return a.same_buffer(b) || a.str() == b.str(); }
+    friend bool operator!=(const Snapshot& a, const Snapshot& b) { return !(a == b); }
+    friend bool operator==(const Snapshot& a, std::string_view b) { return a.view() == b; }
+    friend bool operator!=(const Snapshot& a, std::string_view b) { return a.view() != b; }
+    friend bool operator==(std::string_view a, const Snapshot& b) { return a == b.view(); }
+    friend bool operator!=(std::string_view a, const Snapshot& b) { return a != b.view(); }
+
+private:
+    static const std::string& empty_() {
+        static const std::string e;
+        return e;
+    }
+
+    std::shared_ptr<const std::string> p_;
+};
+
+// std::string_view into a Snapshot that pins the buffer
+// - valid as long as this handle (or a copy, or a view cut from it) is alive
+// - cutting sub-views does not touch the source object or its lock; copying a handle bumps a reference count,
+//   so inner loops should work on view() and keep one handle per message
+class SnapshotView {
+public:
+    SnapshotView() = default;
+    SnapshotView(Snapshot snap, std::string_view v) : snap_(std::move(snap)), v_(v) {}
+
+    std::string_view view() const { return v_; }
+    operator std::string_view() const { return v_; }
+    std::string str() const { return std::string(v_); }
+
+    const char* data() const { return v_.data(); }
+    std::size_t size() const { return v_.size(); }
+    std::size_t length() const { return v_.size(); }
+    bool empty() const { return v_.empty(); }
+    char operator[](std::size_t pos) const { return v_[pos]; }
+    std::string_view::const_iterator begin() const { return v_.begin(); }
+    std::string_view::const_iterator end() const { return v_.end(); }
+
+    // sub-view of this view, sharing the pin (throws std::out_of_range if pos > size())
+    SnapshotView substr_view(std::size_t pos = 0, std::size_t count = std::string_view::npos) const {
+        return SnapshotView{snap_, v_.substr(pos, count)};
+    }
+    // plain sub-view, valid while this handle is alive
+    std::string_view view(std::size_t pos, std::size_t count = std::string_view::npos) const {
+        return v_.substr(pos, count);
+    }
+
+    // the pinned snapshot (the whole value the view was cut from)
+    const Snapshot& snapshot() const { return snap_; }
+
+    friend bool operator==(const SnapshotView& a, std::string_view b) { return a.v_ == b; }
+    friend bool operator!=(const SnapshotView& a, std::string_view b) { return a.v_ != b; }
+    friend bool operator==(std::string_view a, const SnapshotView& b) { return a == b.v_; }
+    friend bool operator!=(std::string_view a, const SnapshotView& b) { return a != b.v_; }
+    friend bool operator==(const SnapshotView& a, const SnapshotView& b) { return a.v_ == b.v_; }
+    friend bool operator!=(const SnapshotView& a, const SnapshotView& b) { return a.v_ != b.v_; }
+
+private:
+    Snapshot snap_;
+    std::string_view v_;
+};
+
+inline SnapshotView Snapshot::substr_view(std::size_t pos, std::size_t count) const {
+    return SnapshotView{*this, view().substr(pos, count)};
+}
+
+} // namespace j2
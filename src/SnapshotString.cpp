@@ -0,0 +1,138 @@
+#include "SnapshotString.hpp"
+
+namespace j2 {
+
+// ================= atomic publish/load =================
+std::shared_ptr<const std::string> SnapshotString::load_() const {
+    // 1) count ourselves in the word: the node cannot be freed while we are counted
+    const std::uint64_t word = cur_.fetch_add(kReader, std::memory_order_acquire) + kReader;
+    if (is_far_(word)) {
+        // lock-based for good: the count is never taken back (it wraps in the high bits, kFar stays)
+        std::scoped_lock lock(fm_);
+        return far_;
+    }
+    Node* node = node_of_(word);
+    std::shared_ptr<const std::string> value = node->value;
+    // 2) uncount: in the word while it still holds this node, else on the node (the publisher moved our mark)
+    std::uint64_t expected = word;
+    for (;;) {
+        if (node_of_(expected) != node) {
+            if (node->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) delete node;
+            break;
+        }
+        if (cur_.compare_exchange_weak(expected, expected - kReader, std::memory_order_release, std::memory_order_relaxed)) break;
+    }
+    return value;
+}
+
+std::shared_ptr<const std::string> SnapshotString::load_locked_() const {
+    const std::uint64_t word = cur_.load(std::memory_order_acquire);
+    return is_far_(word) ? far_ : node_of_(word)->value;
+}
+
+// wm_ held (or constructing)
+void SnapshotString::publish_(std::shared_ptr<const std::string> next) {
+    if (is_far_(cur_.load(std::memory_order_relaxed))) {
+        {
+            std::scoped_lock lock(fm_);
+            far_.swap(next);
+        }
+        return;   // next now holds the previous value, released outside fm_
+    }
+    // the previous buffer is released when its last reader drops its Snapshot
+    auto* node = new Node;
+    node->value = std::move(next);
+    std::uint64_t word = reinterpret_cast<std::uintptr_t>(node);
+#if defined(J2_SNAPSHOT_STRING_LOCKED)
+    word |= kReader;   // testing: take the fallback below as if the address were too high
+#endif
+    if (word & ~(kReader - 1)) {
+        // no room for the reader count: switch this object to reads under fm_
+        std::scoped_lock lock(fm_);
+        far_ = std::move(node->value);
+        delete node;
+        word = kFar;
+    }
+    retire_(cur_.exchange(word, std::memory_order_acq_rel));
+}
+
+// a node taken out of cur_: freed once every reader counted in its word has finished copying value
+void SnapshotString::retire_(std::uint64_t word) noexcept {
+    if (is_far_(word)) return;   // no node: far_ is released with the object
+    Node* node = node_of_(word);
+    if (!node) return;
+    const auto readers = static_cast<std::int64_t>(word / kReader);
+    if (node->pending.fetch_add(readers, std::memory_order_acq_rel) + readers == 0) delete node;
+}
+
+// ================= constructors/assignments =================
+SnapshotString::SnapshotString() : SnapshotString(std::string()) {}
+SnapshotString::SnapshotString(std::string s) { publish_(std::make_shared<const std::string>(std::move(s))); }
+SnapshotString::SnapshotString(const char* s) : SnapshotString(std::string(s ? s : "")) {}
+
+SnapshotString::SnapshotString(const SnapshotString& other) { publish_(other.load_()); }
+SnapshotString::~SnapshotString() { retire_(cur_.load(std::memory_order_acquire)); }
+
+SnapshotString& SnapshotString::operator=(const SnapshotString& other) {
+    if (this != &other) {
+        auto next = other.load_();
+        std::scoped_lock lock(wm_);
+        publish_(std::move(next));
+    }
+    return *this;
+}
+
+SnapshotString& SnapshotString::operator=(const std::string& rhs) { assign(rhs); return *this; }
+SnapshotString& SnapshotString::operator=(const char* rhs) { assign(rhs ? rhs : ""); return *this; }
+
+// ================= snapshot =================
+Snapshot SnapshotString::snapshot() const { return Snapshot{load_()}; }
+
+// ================= read members (current snapshot) =================
+std::size_t SnapshotString::size() const { return load_()->size(); }
+bool SnapshotString::empty() const { return load_()->empty(); }
+char SnapshotString::at(std::size_t pos) const { return load_()->at(pos); }
+char SnapshotString::operator[](std::size_t pos) const { return (*load_())[pos]; }
+char SnapshotString::front() const { return load_()->front(); }
+char SnapshotString::back() const { return load_()->back(); }
+
+std::string SnapshotString::substr(std::size_t pos, std::size_t count) const { return load_()->substr(pos, count); }
+int SnapshotString::compare(std::string_view s) const { return load_()->compare(s); }
+std::size_t SnapshotString::find(std::string_view s, std::size_t pos) const { return load_()->find(s, pos); }
+std::size_t SnapshotString::find(char ch, std::size_t pos) const { return load_()->find(ch, pos); }
+std::size_t SnapshotString::rfind(std::string_view s, std::size_t pos) const { return load_()->rfind(s, pos); }
+std::size_t SnapshotString::rfind(char ch, std::size_t pos) const { return load_()->rfind(ch, pos); }
+
+// ================= modifiers =================
+// a whole-value replacement does not need the old value: no copy, only the publish is serialized
+void SnapshotString::clear() { assign(std::string()); }
+void SnapshotString::assign(std::string s) {
+    auto next = std::make_shared<const std::string>(std::move(s));
+    std::scoped_lock lock(wm_);
+    publish_(std::move(next));
+}
+
+void SnapshotString::push_back(char ch) { update([&](std::string& s) { s.push_back(ch); }); }
+SnapshotString& SnapshotString::append(std::string_view s) {
+    update([&](std::string& cur) { cur.append(s); });
+    return *this;
+}
+SnapshotString& SnapshotString::append(std::size_t count, char ch) {
+    update([&](std::string& cur) { cur.append(count, ch); });
+    return *this;
+}
+SnapshotString& SnapshotString::insert(std::size_t pos, std::string_view s) {
+    update([&](std::string& cur) { cur.insert(pos, s); });
+    return *this;
+}
+SnapshotString& SnapshotString::erase(std::size_t pos, std::size_t count) {
+    update([&](std::string& cur) { cur.erase(pos, count); });
+    return *this;
+}
+SnapshotString& SnapshotString::replace(std::size_t pos, std::size_t count, std::string_view s) {
+    update([&](std::string& cur) { cur.replace(pos, count, s); });
+    return *this;
+}
+void SnapshotString::resize(std::size_t n, char ch) { update([&](std::string& cur) { cur.resize(n, ch); }); }
+
+} // namespace j2
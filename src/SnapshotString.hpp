@@ -0,0 +1,143 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <utility>
+#include <type_traits>
+#include <cstdint>
+
+#include "Snapshot.hpp"
+
+// j2 namespace
+namespace j2 {
+
+// RCU-style (read-copy-update) thread-safe string
+// - the current value is an immutable std::string published through one atomic word (split reference count,
+//   see load_()): readers never take a mutex, not even the process-wide one libstdc++ uses for
+//   std::atomic_load on a shared_ptr before C++20
+// - readers take a reference-counted Snapshot: no buffer copy, so str() is O(1); a read is three atomic
+//   operations on shared cache lines (the word and the buffer's count), so it scales with readers until
+//   those lines saturate
+// - writers serialize on a writer mutex, build the new value on the side and publish it atomically;
+//   every write therefore copies the string once (O(n)) — use for read-mostly values (config, labels)
+// - a reader keeps seeing the snapshot it took, even while writers publish newer values
+class SnapshotString {
+public:
+    // ===== constructors/assignments =====
+    SnapshotString();                             // empty string
+    SnapshotString(std::string s);
+    SnapshotString(const char* s);
+
+    SnapshotString(const SnapshotString& other);  // shares the other's current buffer (O(1))
+    SnapshotString& operator=(const SnapshotString& other);
+    ~SnapshotString();
+
+    SnapshotString& operator=(const std::string& rhs);
+    SnapshotString& operator=(const char* rhs);
+
+    // ===== snapshot (read, O(1)) =====
+    Snapshot snapshot() const;
+    Snapshot str() const { return snapshot(); }   // keep the handle: auto snap = ss.str();
+
+    // zero-copy substrings pinned to the current snapshot (see SnapshotView)
+    SnapshotView substr_view(std::size_t pos = 0, std::size_t count = std::string::npos) const {
+        return snapshot().substr_view(pos, count);
+    }
+    SnapshotView views() const { return snapshot().substr_view(); }
+
+    // comparison (read)
+    bool operator==(std::string_view rhs) const { return snapshot() == rhs; }
+    bool operator==(const char* rhs) const { return snapshot() == std::string_view(rhs ? rhs : ""); }
+    bool operator!=(std::string_view rhs) const { return !(*this == rhs); }
+    bool operator!=(const char* rhs) const { return !(*this == rhs); }
+    friend inline bool operator==(std::string_view lhs, const SnapshotString& rhs) { return rhs == lhs; }
+    friend inline bool operator==(const char* lhs, const SnapshotString& rhs) { return rhs == lhs; }
+    friend inline bool operator!=(std::string_view lhs, const SnapshotString& rhs) { return !(rhs == lhs); }
+    friend inline bool operator!=(const char* lhs, const SnapshotString& rhs) { return !(rhs == lhs); }
+
+    // ===== capacity/status/element access (read, on the current snapshot) =====
+    std::size_t size() const;
+    std::size_t length() const { return size(); }
+    bool empty() const;
+    char at(std::size_t pos) const;
+    char operator[](std::size_t pos) const;
+    char front() const;
+    char back() const;
+
+    // ===== string operations (read, on the current snapshot) =====
+    std::string substr(std::size_t pos = 0, std::size_t count = std::string::npos) const;
+    int compare(std::string_view s) const;
+    std::size_t find(std::string_view s, std::size_t pos = 0) const;
+    std::size_t find(char ch, std::size_t pos = 0) const;
+    std::size_t rfind(std::string_view s, std::size_t pos = std::string::npos) const;
+    std::size_t rfind(char ch, std::size_t pos = std::string::npos) const;
+
+    // ===== modifiers (copy, modify, publish) =====
+    void clear();
+    void assign(std::string s);
+    void push_back(char ch);
+    SnapshotString& append(std::string_view s);
+    SnapshotString& append(std::size_t count, char ch);
+    SnapshotString& operator+=(std::string_view s) { return append(s); }
+    SnapshotString& operator+=(const char* s) { return append(s ? s : ""); }
+    SnapshotString& operator+=(char ch) { push_back(ch); return *this; }
+    SnapshotString& insert(std::size_t pos, std::string_view s);
+    SnapshotString& erase(std::size_t pos = 0, std::size_t count = std::string::npos);
+    SnapshotString& replace(std::size_t pos, std::size_t count, std::string_view s);
+    void resize(std::size_t n, char ch = '\0');
+
+    // read: f(const std::string&) on the current snapshot, no lock held
+    // (there is no mutable with(): writes go through update() so their O(n) cost is visible)
+    template <typename Fn>
+    auto with(Fn&& f) const -> decltype(std::forward<Fn>(f)(std::declval<const std::string&>())) {
+        Snapshot snap = snapshot();
+        return std::forward<Fn>(f)(snap.str());
+    }
+
+    // write: f(std::string&) on a private copy of the current value, published when f returns
+    // (writers are serialized, so read-modify-write sequences inside f are atomic)
+    template <typename Fn>
+    auto update(Fn&& f) -> decltype(std::forward<Fn>(f)(std::declval<std::string&>())) {
+        std::scoped_lock lock(wm_);
+        auto next = std::make_shared<std::string>(*load_locked_());
+        if constexpr (std::is_void_v<decltype(std::forward<Fn>(f)(*next))>) {
+            std::forward<Fn>(f)(*next);
+            publish_(std::move(next));
+        } else {
+            auto r = std::forward<Fn>(f)(*next);
+            publish_(std::move(next));
+            return r;
+        }
+    }
+
+protected:
+    // published value: cur_ holds the Node pointer (low 48 bits) and the number of readers that are still
+    // copying node->value (high 16 bits); a reader that finds the node replaced settles with pending instead
+    // - a node address that does not fit in 48 bits (5-level paging, tagged pointers) leaves no room for the
+    //   count: the object then sets cur_ to kFar for good and readers copy far_ under fm_ (correct, not lock-free)
+    struct Node {
+        std::shared_ptr<const std::string> value;
+        std::atomic<std::int64_t> pending{0};   // readers done after the swap minus readers counted in the word
+    };
+    static constexpr std::uint64_t kReader = std::uint64_t{1} << 48;
+    static constexpr std::uint64_t kFar = 1;   // never a Node address (nodes are at least 8-byte aligned)
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "SnapshotString needs a lock-free 64-bit atomic");
+
+    std::shared_ptr<const std::string> load_() const;
+    std::shared_ptr<const std::string> load_locked_() const;   // wm_ held: nothing can retire the current value
+    void publish_(std::shared_ptr<const std::string> next);
+    static void retire_(std::uint64_t word) noexcept;
+    static bool is_far_(std::uint64_t word) noexcept { return (word & (kReader - 1)) == kFar; }
+    static Node* node_of_(std::uint64_t word) noexcept {
+        return reinterpret_cast<Node*>(static_cast<std::uintptr_t>(word & (kReader - 1)));
+    }
+
+    mutable std::atomic<std::uint64_t> cur_{0};
+    std::mutex wm_;                            // writers only
+    mutable std::mutex fm_;                    // far_ (never taken while cur_ holds a node)
+    std::shared_ptr<const std::string> far_;   // the value once cur_ is kFar
+};
+
+} // namespace j2
@@ -0,0 +1,512 @@
+#include "StringSearch.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define J2_SEARCH_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+// kernels for a higher instruction set are compiled for that set only (no global -mavx2):
+// they are called only after simd_level() has confirmed the CPU supports it
+#if defined(__GNUC__) || defined(__clang__)
+#define J2_TARGET(isa) __attribute__((target(isa)))
+#else
+#define J2_TARGET(isa)   // MSVC emits any intrinsic without a target switch
+#endif
+
+namespace j2 {
+
+namespace {
+
+constexpr std::size_t npos = std::string_view::npos;
+
+// index of the lowest / highest set bit of a non-zero match mask
+inline unsigned lowest_bit(std::uint64_t m) noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long i;
+#if defined(_M_X64)
+    _BitScanForward64(&i, m);
+    return static_cast<unsigned>(i);
+#else
+    if (static_cast<std::uint32_t>(m)) { _BitScanForward(&i, static_cast<std::uint32_t>(m)); return static_cast<unsigned>(i); }
+    _BitScanForward(&i, static_cast<std::uint32_t>(m >> 32));
+    return static_cast<unsigned>(i) + 32;
+#endif
+#else
+    return static_cast<unsigned>(__builtin_ctzll(m));
+#endif
+}
+inline unsigned highest_bit(std::uint64_t m) noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long i;
+#if defined(_M_X64)
+    _BitScanReverse64(&i, m);
+    return static_cast<unsigned>(i);
+#else
+    if (m >> 32) { _BitScanReverse(&i, static_cast<std::uint32_t>(m >> 32)); return static_cast<unsigned>(i) + 32; }
+    _BitScanReverse(&i, static_cast<std::uint32_t>(m));
+    return static_cast<unsigned>(i);
+#endif
+#else
+    return 63u - static_cast<unsigned>(__builtin_clzll(m));
+#endif
+}
+
+// ================= block kernels =================
+// every kernel gets arguments already checked by the wrappers below:
+// - find_sub: 2 <= k, pos + k <= n          (candidates pos .. n-k)
+// - find_pair: as find_sub, plus r1 != r2 < k (needle offsets of the filter bytes, see Searcher)
+// - rfind_sub: 2 <= k, last + k <= n         (candidates last .. 0)
+// - find_chr: pos < n                        (positions pos .. n-1)
+// - rfind_chr: last < n                      (positions last .. 0)
+// full vector blocks are scanned with SIMD, the remainder with std::string_view
+
+// ---------- scalar (std::string_view, i.e. the standard library's own search) ----------
+// find_chr_scalar is used at every level: it is memchr, which the C library already vectorizes and
+// dispatches itself (glibc picks its AVX2/EVEX version at load time), and measured faster than a kernel here
+std::size_t find_sub_scalar(const char* h, std::size_t n, const char* nd, std::size_t k, std::size_t pos) noexcept {
+    return std::string_view(h, n).find(std::string_view(nd, k), pos);
+}
+std::size_t find_pair_scalar(const char* h, std::size_t n, const char* nd, std::size_t k, std::size_t, std::size_t,
+                             std::size_t pos) noexcept {
+    return find_sub_scalar(h, n, nd, k, pos);
+}
+std::size_t rfind_sub_scalar(const char* h, std::size_t n, const char* nd, std::size_t k, std::size_t last) noexcept {
+    return std::string_view(h, n).rfind(std::string_view(nd, k), last);
+}
+std::size_t find_chr_scalar(const char* h, std::size_t n, char c, std::size_t pos) noexcept {
+    return std::string_view(h, n).find(c, pos);
+}
+std::size_t rfind_chr_scalar(const char* h, std::size_t n, char c, std::size_t last) noexcept {
+    return std::string_view(h, n).rfind(c, last);
+}
+// byte sets: one table lookup per byte (the standard library scans the whole set for every byte)
+std::size_t find_of_scalar(const char* h, std::size_t n, const detail::CharSet& set, bool member, std::size_t i) noexcept {
+    for (; i < n; ++i) {
+        if (set.contains(h[i]) == member) return i;
+    }
+    return npos;
+}
+std::size_t rfind_of_scalar(const char* h, std::size_t, const detail::CharSet& set, bool member, std::size_t i) noexcept {
+    for (;; --i) {
+        if (set.contains(h[i]) == member) return i;
+        if (i == 0) return npos;
+    }
+}
+
+#if defined(J2_SEARCH_X86)
+// ---------- SSE2 (16-byte blocks) ----------
+J2_TARGET("sse2")
+std::size_t find_sub_sse2(const char* h, std::size_t n, const char* nd, std::size_t k, std::size_t i) noexcept {
+    const __m128i first = _mm_set1_epi8(nd[0]);
+    const __m128i last = _mm_set1_epi8(nd[k - 1]);
+    for (; i + k - 1 + 16 <= n; i += 16) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i + k - 1));
+        std::uint64_t m = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last))));
+        for (; m; m &= m - 1) {
+            const std::size_t at = i + lowest_bit(m);
+            if (std::memcmp(h + at + 1, nd + 1, k - 2) == 0) return at;
+        }
+    }
+    return find_sub_scalar(h, n, nd, k, i);
+}
+J2_TARGET("sse2")
+std::size_t find_pair_sse2(const char* h, std::size_t n, const char* nd, std::size_t k, std::size_t r1, std::size_t r2,
+                          std::size_t i) noexcept {
+    const __m128i b1 = _mm_set1_epi8(nd[r1]);
+    const __m128i b2 = _mm_set1_epi8(nd[r2]);
+    for (; i + k - 1 + 16 <= n; i += 16) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i + r1));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i + r2));
+        std::uint64_t m = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, b1), _mm_cmpeq_epi8(b, b2))));
+        for (; m; m &= m - 1) {
+            const std::size_t at = i + lowest_bit(m);
+            if (std::memcmp(h + at, nd, k) == 0) return at;
+        }
+    }
+    return find_sub_scalar(h, n, nd, k, i);
+}
+J2_TARGET("sse2")
+std::size_t rfind_sub_sse2(const char* h, std::size_t n, const char* nd, std::size_t k, std::size_t i) noexcept {
+    const __m128i first = _mm_set1_epi8(nd[0]);
+    const __m128i last = _mm_set1_epi8(nd[k - 1]);
+    for (; i + 1 >= 16; i -= 16) {
+        const std::size_t s = i + 1 - 16;   // block of candidates s .. i
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + s));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + s + k - 1));
+        std::uint64_t m = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last))));
+        for (; m; m &= ~(std::uint64_t{1} << highest_bit(m))) {
+            const std::size_t at = s + highest_bit(m);
+            if (std::memcmp(h + at + 1, nd + 1, k - 2) == 0) return at;
+        }
+        if (s == 0) return npos;
+    }
+    return rfind_sub_scalar(h, n, nd, k, i);
+}
+J2_TARGET("sse2")
+std::size_t rfind_chr_sse2(const char* h, std::size_t n, char c, std::size_t i) noexcept {
+    const __m128i v = _mm_set1_epi8(c);
+    for (; i + 1 >= 16; i -= 16) {
+        const std::size_t s = i + 1 - 16;
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + s));
+        if (const unsigned m = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, v)))) return s + highest_bit(m);
+        if (s == 0) return npos;
+    }
+    return rfind_chr_scalar(h, n, c, i);
+}
+
+// ---------- AVX2 (32-byte blocks) ----------
+J2_TARGET("avx2")
+std::size_t find_sub_avx2(const char* h, std::size_t n, const char* nd, std::size_t k, std::size_t i) noexcept {
+    const __m256i first = _mm256_set1_epi8(nd[0]);
+    const __m256i last = _mm256_set1_epi8(nd[k - 1]);
+    for (; i + k - 1 + 32 <= n; i += 32) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + i + k - 1));
+        std::uint64_t m = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last))));
+        for (; m; m &= m - 1) {
+            const std::size_t at = i + lowest_bit(m);
+            if (std::memcmp(h + at + 1, nd + 1, k - 2) == 0) return at;
+        }
+    }
+    return find_sub_sse2(h, n, nd, k, i);
+}
+J2_TARGET("avx2")
+std::size_t find_pair_avx2(const char* h, std::size_t n, const char* nd, std::size_t k, std::size_t r1, std::size_t r2,
+                          std::size_t i) noexcept {
+    const __m256i b1 = _mm256_set1_epi8(nd[r1]);
+    const __m256i b2 = _mm256_set1_epi8(nd[r2]);
+    for (; i + k - 1 + 32 <= n; i += 32) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + i + r1));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + i + r2));
+        std::uint64_t m = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, b1), _mm256_cmpeq_epi8(b, b2))));
+        for (; m; m &= m - 1) {
+            const std::size_t at = i + lowest_bit(m);
+            if (std::memcmp(h + at, nd, k) == 0) return at;
+        }
+    }
+    return find_pair_sse2(h, n, nd, k, r1, r2, i);
+}
+J2_TARGET("avx2")
+std::size_t rfind_sub_avx2(const char* h, std::size_t n, const char* nd, std::size_t k, std::size_t i) noexcept {
+    const __m256i first = _mm256_set1_epi8(nd[0]);
+    const __m256i last = _mm256_set1_epi8(nd[k - 1]);
+    for (; i + 1 >= 32; i -= 32) {
+        const std::size_t s = i + 1 - 32;
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + s));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + s + k - 1));
+        std::uint64_t m = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last))));
+        for (; m; m &= ~(std::uint64_t{1} << highest_bit(m))) {
+            const std::size_t at = s + highest_bit(m);
+            if (std::memcmp(h + at + 1, nd + 1, k - 2) == 0) return at;
+        }
+        if (s == 0) return npos;
+    }
+    return rfind_sub_sse2(h, n, nd, k, i);
+}
+J2_TARGET("avx2")
+std::size_t rfind_chr_avx2(const char* h, std::size_t n, char c, std::size_t i) noexcept {
+    const __m256i v = _mm256_set1_epi8(c);
+    for (; i + 1 >= 32; i -= 32) {
+        const std::size_t s = i + 1 - 32;
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + s));
+        if (const unsigned m = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, v)))) return s + highest_bit(m);
+        if (s == 0) return npos;
+    }
+    return rfind_chr_sse2(h, n, c, i);
+}
+
+// ---------- AVX-512BW (64-byte blocks, mask registers) ----------
+J2_TARGET("avx512f,avx512bw")
+std::size_t find_sub_avx512(const char* h, std::size_t n, const char* nd, std::size_t k, std::size_t i) noexcept {
+    const __m512i first = _mm512_set1_epi8(nd[0]);
+    const __m512i last = _mm512_set1_epi8(nd[k - 1]);
+    for (; i + k - 1 + 64 <= n; i += 64) {
+        const __m512i a = _mm512_loadu_si512(h + i);
+        const __m512i b = _mm512_loadu_si512(h + i + k - 1);
+        std::uint64_t m = _mm512_mask_cmpeq_epi8_mask(_mm512_cmpeq_epi8_mask(a, first), b, last);
+        for (; m; m &= m - 1) {
+            const std::size_t at = i + lowest_bit(m);
+            if (std::memcmp(h + at + 1, nd + 1, k - 2) == 0) return at;
+        }
+    }
+    return find_sub_avx2(h, n, nd, k, i);
+}
+J2_TARGET("avx512f,avx512bw")
+std::size_t find_pair_avx512(const char* h, std::size_t n, const char* nd, std::size_t k, std::size_t r1, std::size_t r2,
+                          std::size_t i) noexcept {
+    const __m512i b1 = _mm512_set1_epi8(nd[r1]);
+    const __m512i b2 = _mm512_set1_epi8(nd[r2]);
+    for (; i + k - 1 + 64 <= n; i += 64) {
+        const __m512i a = _mm512_loadu_si512(h + i + r1);
+        const __m512i b = _mm512_loadu_si512(h + i + r2);
+        std::uint64_t m = _mm512_mask_cmpeq_epi8_mask(_mm512_cmpeq_epi8_mask(a, b1), b, b2);
+        for (; m; m &= m - 1) {
+            const std::size_t at = i + lowest_bit(m);
+            if (std::memcmp(h + at, nd, k) == 0) return at;
+        }
+    }
+    return find_pair_avx2(h, n, nd, k, r1, r2, i);
+}
+J2_TARGET("avx512f,avx512bw")
+std::size_t rfind_sub_avx512(const char* h, std::size_t n, const char* nd, std::size_t k, std::size_t i) noexcept {
+    const __m512i first = _mm512_set1_epi8(nd[0]);
+    const __m512i last = _mm512_set1_epi8(nd[k - 1]);
+    for (; i + 1 >= 64; i -= 64) {
+        const std::size_t s = i + 1 - 64;
+        const __m512i a = _mm512_loadu_si512(h + s);
+        const __m512i b = _mm512_loadu_si512(h + s + k - 1);
+        std::uint64_t m = _mm512_mask_cmpeq_epi8_mask(_mm512_cmpeq_epi8_mask(a, first), b, last);
+        for (; m; m &= ~(std::uint64_t{1} << highest_bit(m))) {
+            const std::size_t at = s + highest_bit(m);
+            if (std::memcmp(h + at + 1, nd + 1, k - 2) == 0) return at;
+        }
+        if (s == 0) return npos;
+    }
+    return rfind_sub_avx2(h, n, nd, k, i);
+}
+J2_TARGET("avx512f,avx512bw")
+std::size_t rfind_chr_avx512(const char* h, std::size_t n, char c, std::size_t i) noexcept {
+    const __m512i v = _mm512_set1_epi8(c);
+    for (; i + 1 >= 64; i -= 64) {
+        const std::size_t s = i + 1 - 64;
+        if (const std::uint64_t m = _mm512_cmpeq_epi8_mask(_mm512_loadu_si512(h + s), v)) return s + highest_bit(m);
+        if (s == 0) return npos;
+    }
+    return rfind_chr_avx2(h, n, c, i);
+}
+
+// ---------- byte sets: nibble shuffles (AVX2 / AVX-512BW) ----------
+// bit (hi & 7) of each byte's high nibble, in both 8-entry halves of a shuffle table
+#define J2_BIT_OF_HI 1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128
+
+// one bit per byte of v: member of set
+J2_TARGET("avx2")
+inline std::uint32_t members_avx2(__m256i v, __m256i row0, __m256i row1) noexcept {
+    const __m256i nib = _mm256_set1_epi8(0x0f);
+    const __m256i bit_of_hi = _mm256_setr_epi8(J2_BIT_OF_HI, J2_BIT_OF_HI);
+    const __m256i lo = _mm256_and_si256(v, nib);
+    const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), nib);
+    // the byte's own top bit (hi >= 8) picks the row
+    const __m256i row = _mm256_blendv_epi8(_mm256_shuffle_epi8(row0, lo), _mm256_shuffle_epi8(row1, lo), v);
+    const __m256i hit = _mm256_and_si256(row, _mm256_shuffle_epi8(bit_of_hi, hi));
+    return ~static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hit, _mm256_setzero_si256())));
+}
+J2_TARGET("avx2")
+std::size_t find_of_avx2(const char* h, std::size_t n, const detail::CharSet& set, bool member, std::size_t i) noexcept {
+    const __m256i row0 = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(set.rows[0])));
+    const __m256i row1 = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(set.rows[1])));
+    const std::uint32_t flip = member ? 0 : ~0u;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + i));
+        if (const std::uint32_t m = members_avx2(v, row0, row1) ^ flip) return i + lowest_bit(m);
+    }
+    return find_of_scalar(h, n, set, member, i);
+}
+J2_TARGET("avx2")
+std::size_t rfind_of_avx2(const char* h, std::size_t n, const detail::CharSet& set, bool member, std::size_t i) noexcept {
+    const __m256i row0 = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(set.rows[0])));
+    const __m256i row1 = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(set.rows[1])));
+    const std::uint32_t flip = member ? 0 : ~0u;
+    for (; i + 1 >= 32; i -= 32) {
+        const std::size_t s = i + 1 - 32;
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + s));
+        if (const std::uint32_t m = members_avx2(v, row0, row1) ^ flip) return s + highest_bit(m);
+        if (s == 0) return npos;
+    }
+    return rfind_of_scalar(h, n, set, member, i);
+}
+
+// 16-byte table in every lane (zero-masked form: the plain intrinsic trips -Wuninitialized inside GCC 12's header)
+J2_TARGET("avx512f,avx512bw")
+inline __m512i broadcast_row_(__m128i row) noexcept {
+    return _mm512_maskz_broadcast_i32x4(static_cast<__mmask16>(0xffff), row);
+}
+J2_TARGET("avx512f,avx512bw")
+inline std::uint64_t members_avx512(__m512i v, __m512i row0, __m512i row1) noexcept {
+    const __m512i nib = _mm512_set1_epi8(0x0f);
+    const __m512i bit_of_hi = broadcast_row_(_mm_setr_epi8(J2_BIT_OF_HI));
+    const __m512i lo = _mm512_and_si512(v, nib);
+    const __m512i hi = _mm512_and_si512(_mm512_srli_epi16(v, 4), nib);
+    const __m512i row = _mm512_mask_blend_epi8(_mm512_movepi8_mask(v), _mm512_shuffle_epi8(row0, lo), _mm512_shuffle_epi8(row1, lo));
+    return _mm512_test_epi8_mask(row, _mm512_shuffle_epi8(bit_of_hi, hi));
+}
+J2_TARGET("avx512f,avx512bw")
+std::size_t find_of_avx512(const char* h, std::size_t n, const detail::CharSet& set, bool member, std::size_t i) noexcept {
+    const __m512i row0 = broadcast_row_(_mm_load_si128(reinterpret_cast<const __m128i*>(set.rows[0])));
+    const __m512i row1 = broadcast_row_(_mm_load_si128(reinterpret_cast<const __m128i*>(set.rows[1])));
+    const std::uint64_t flip = member ? 0 : ~std::uint64_t{0};
+    for (; i + 64 <= n; i += 64) {
+        if (const std::uint64_t m = members_avx512(_mm512_loadu_si512(h + i), row0, row1) ^ flip) return i + lowest_bit(m);
+    }
+    return find_of_avx2(h, n, set, member, i);
+}
+J2_TARGET("avx512f,avx512bw")
+std::size_t rfind_of_avx512(const char* h, std::size_t n, const detail::CharSet& set, bool member, std::size_t i) noexcept {
+    const __m512i row0 = broadcast_row_(_mm_load_si128(reinterpret_cast<const __m128i*>(set.rows[0])));
+    const __m512i row1 = broadcast_row_(_mm_load_si128(reinterpret_cast<const __m128i*>(set.rows[1])));
+    const std::uint64_t flip = member ? 0 : ~std::uint64_t{0};
+    for (; i + 1 >= 64; i -= 64) {
+        const std::size_t s = i + 1 - 64;
+        if (const std::uint64_t m = members_avx512(_mm512_loadu_si512(h + s), row0, row1) ^ flip) return s + highest_bit(m);
+        if (s == 0) return npos;
+    }
+    return rfind_of_avx2(h, n, set, member, i);
+}
+#undef J2_BIT_OF_HI
+#endif // J2_SEARCH_X86
+
+// ================= std::string_view semantics around the kernels =================
+using SubKernel = std::size_t (*)(const char*, std::size_t, const char*, std::size_t, std::size_t) noexcept;
+using ChrKernel = std::size_t (*)(const char*, std::size_t, char, std::size_t) noexcept;
+using PairKernel = std::size_t (*)(const char*, std::size_t, const char*, std::size_t, std::size_t, std::size_t,
+                                   std::size_t) noexcept;
+
+template <ChrKernel Chr>
+std::size_t find_char_(std::string_view hay, char ch, std::size_t pos) noexcept {
+    if (pos >= hay.size()) return npos;
+    return Chr(hay.data(), hay.size(), ch, pos);
+}
+template <ChrKernel RChr>
+std::size_t rfind_char_(std::string_view hay, char ch, std::size_t pos) noexcept {
+    if (hay.empty()) return npos;
+    return RChr(hay.data(), hay.size(), ch, std::min(pos, hay.size() - 1));
+}
+template <SubKernel Sub, ChrKernel Chr>
+std::size_t find_(std::string_view hay, std::string_view needle, std::size_t pos) noexcept {
+    const std::size_t n = hay.size(), k = needle.size();
+    if (k == 0) return pos <= n ? pos : npos;
+    if (pos >= n || k > n - pos) return npos;
+    if (k == 1) return Chr(hay.data(), n, needle[0], pos);
+    return Sub(hay.data(), n, needle.data(), k, pos);
+}
+template <PairKernel Pair, ChrKernel Chr>
+std::size_t find_pair_(std::string_view hay, std::string_view needle, std::size_t r1, std::size_t r2, std::size_t pos) noexcept {
+    const std::size_t n = hay.size(), k = needle.size();
+    if (k == 0) return pos <= n ? pos : npos;
+    if (pos >= n || k > n - pos) return npos;
+    if (k == 1) return Chr(hay.data(), n, needle[0], pos);
+    return Pair(hay.data(), n, needle.data(), k, r1, r2, pos);
+}
+template <SubKernel RSub, ChrKernel RChr>
+std::size_t rfind_(std::string_view hay, std::string_view needle, std::size_t pos) noexcept {
+    const std::size_t n = hay.size(), k = needle.size();
+    if (k > n) return npos;
+    const std::size_t last = std::min(pos, n - k);
+    if (k == 0) return last;
+    if (k == 1) return RChr(hay.data(), n, needle[0], last);
+    return RSub(hay.data(), n, needle.data(), k, last);
+}
+
+using SetKernel = std::size_t (*)(const char*, std::size_t, const detail::CharSet&, bool, std::size_t) noexcept;
+
+template <SetKernel Of>
+std::size_t find_of_(std::string_view hay, const detail::CharSet& set, bool member, std::size_t pos) noexcept {
+    if (pos >= hay.size()) return npos;
+    return Of(hay.data(), hay.size(), set, member, pos);
+}
+template <SetKernel ROf>
+std::size_t rfind_of_(std::string_view hay, const detail::CharSet& set, bool member, std::size_t pos) noexcept {
+    if (hay.empty()) return npos;
+    return ROf(hay.data(), hay.size(), set, member, std::min(pos, hay.size() - 1));
+}
+
+template <SubKernel Sub, ChrKernel Chr, SubKernel RSub, ChrKernel RChr, SetKernel Of, SetKernel ROf, PairKernel Pair>
+constexpr detail::SearchKernels make_kernels() noexcept {
+    return {&find_<Sub, Chr>, &find_char_<Chr>, &rfind_<RSub, RChr>, &rfind_char_<RChr>, &find_of_<Of>, &rfind_of_<ROf>,
+            &find_pair_<Pair, Chr>};
+}
+
+constexpr detail::SearchKernels kScalar = make_kernels<find_sub_scalar, find_chr_scalar, rfind_sub_scalar, rfind_chr_scalar,
+                                                       find_of_scalar, rfind_of_scalar, find_pair_scalar>();
+#if defined(J2_SEARCH_X86)
+constexpr detail::SearchKernels kSse2 = make_kernels<find_sub_sse2, find_chr_scalar, rfind_sub_sse2, rfind_chr_sse2,
+                                                     find_of_scalar, rfind_of_scalar, find_pair_sse2>();
+constexpr detail::SearchKernels kAvx2 = make_kernels<find_sub_avx2, find_chr_scalar, rfind_sub_avx2, rfind_chr_avx2,
+                                                     find_of_avx2, rfind_of_avx2, find_pair_avx2>();
+constexpr detail::SearchKernels kAvx512 = make_kernels<find_sub_avx512, find_chr_scalar, rfind_sub_avx512, rfind_chr_avx512,
+                                                       find_of_avx512, rfind_of_avx512, find_pair_avx512>();
+#endif
+
+// ================= CPU detection =================
+SimdLevel detect_simd_level() noexcept {
+#if defined(J2_SEARCH_X86)
+#if defined(_MSC_VER) && !defined(__clang__)
+    int r[4];
+    __cpuid(r, 0);
+    const int max_leaf = r[0];
+    __cpuid(r, 1);
+    const bool sse2 = (r[3] & (1 << 26)) != 0;
+    const bool osxsave = (r[2] & (1 << 27)) != 0;
+    const bool avx = (r[2] & (1 << 28)) != 0;
+    if (!sse2) return SimdLevel::scalar;
+    if (!osxsave || !avx || max_leaf < 7) return SimdLevel::sse2;
+    const unsigned long long xcr0 = _xgetbv(0);
+    if ((xcr0 & 0x6) != 0x6) return SimdLevel::sse2;               // OS saves xmm/ymm
+    __cpuidex(r, 7, 0);
+    const bool avx2 = (r[1] & (1 << 5)) != 0;
+    const bool avx512 = (r[1] & (1 << 16)) != 0 && (r[1] & (1 << 30)) != 0;   // F + BW
+    if (avx512 && (xcr0 & 0xe6) == 0xe6) return SimdLevel::avx512;  // ... and opmask/zmm state
+    return avx2 ? SimdLevel::avx2 : SimdLevel::sse2;
+#else
+    __builtin_cpu_init();   // libgcc/compiler-rt also check that the OS saves the ymm/zmm state
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) return SimdLevel::avx512;
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::avx2;
+    if (__builtin_cpu_supports("sse2")) return SimdLevel::sse2;
+    return SimdLevel::scalar;
+#endif
+#else
+    return SimdLevel::scalar;
+#endif
+}
+
+} // namespace
+
+detail::CharSet::CharSet(std::string_view chars) noexcept {
+    for (char c : chars) {
+        const auto u = static_cast<unsigned char>(c);
+        bits[u >> 6] |= std::uint64_t{1} << (u & 63);
+        rows[u >> 7][u & 0x0f] |= static_cast<std::uint8_t>(1u << ((u >> 4) & 7));
+    }
+}
+
+SimdLevel simd_level() noexcept {
+    static const SimdLevel level = detect_simd_level();
+    return level;
+}
+
+const char* to_string(SimdLevel level) noexcept {
+    switch (level) {
+    case SimdLevel::sse2: return "sse2";
+    case SimdLevel::avx2: return "avx2";
+    case SimdLevel::avx512: return "avx512";
+    default: return "scalar";
+    }
+}
+
+const detail::SearchKernels& detail::search_kernels(SimdLevel level) noexcept {
+    level = std::min(level, simd_level());
+#if defined(J2_SEARCH_X86)
+    switch (level) {
+    case SimdLevel::avx512: return kAvx512;
+    case SimdLevel::avx2: return kAvx2;
+    case SimdLevel::sse2: return kSse2;
+    default: break;
+    }
+#endif
+    return kScalar;
+}
+
+const detail::SearchKernels& detail::search_kernels() noexcept {
+    static const SearchKernels& active = search_kernels(simd_level());
+    return active;
+}
+
+} // namespace j2
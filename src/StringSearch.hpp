@@ -0,0 +1,82 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+// j2 namespace
+namespace j2 {
+
+// instruction set used by the find()/rfind() kernels (StringSearch.cpp)
+enum class SimdLevel { scalar, sse2, avx2, avx512 };
+
+// best level supported by this CPU (and OS), detected once on first use
+SimdLevel simd_level() noexcept;
+const char* to_string(SimdLevel level) noexcept;
+
+namespace detail {
+
+// byte set for find_first_of()/find_last_of()/*_not_of(): built once per call, outside the lock
+// - bits: 256-bit membership table (scalar kernels test one bit per byte instead of scanning the set)
+// - rows: the same table split by nibbles for the vector kernels: rows[hi >= 8][lo] has bit (hi & 7) set
+//   for every member with low nibble lo and high nibble hi, so two byte shuffles classify a whole block
+struct CharSet {
+    explicit CharSet(std::string_view chars) noexcept;
+    explicit CharSet(char ch) noexcept : CharSet(std::string_view(&ch, 1)) {}
+
+    bool contains(char c) const noexcept {
+        const auto u = static_cast<unsigned char>(c);
+        return (bits[u >> 6] >> (u & 63)) & 1;
+    }
+
+    std::uint64_t bits[4] = {};
+    alignas(16) std::uint8_t rows[2][16] = {};
+};
+
+// search kernels of one instruction set; same results as std::string_view::find/rfind
+// - substring search compares the first and last needle character at every position of a vector
+//   block at once and only verifies candidates with memcmp (the needle is never preprocessed)
+// - rfind() scans blocks backwards instead of probing one position at a time
+// - find(char) stays memchr at every level (the C library dispatches its own vector version)
+// - byte-set search classifies 32/64 bytes per step with nibble shuffles (AVX2/AVX-512BW; SSE2 has no
+//   byte shuffle, so that level uses the 256-bit table)
+struct SearchKernels {
+    std::size_t (*find)(std::string_view hay, std::string_view needle, std::size_t pos) noexcept;
+    std::size_t (*find_char)(std::string_view hay, char ch, std::size_t pos) noexcept;
+    std::size_t (*rfind)(std::string_view hay, std::string_view needle, std::size_t pos) noexcept;
+    std::size_t (*rfind_char)(std::string_view hay, char ch, std::size_t pos) noexcept;
+    // first/last position whose byte is (member) or is not (!member) in set, like find_first_of()/find_first_not_of()
+    std::size_t (*find_of)(std::string_view hay, const CharSet& set, bool member, std::size_t pos) noexcept;
+    std::size_t (*rfind_of)(std::string_view hay, const CharSet& set, bool member, std::size_t pos) noexcept;
+    // find() filtering on the needle bytes at offsets r1 and r2 instead of the first and last one
+    // (r1 != r2 < needle.size() when the needle has 2 bytes or more; Searcher picks the rarest two)
+    std::size_t (*find_pair)(std::string_view hay, std::string_view needle, std::size_t r1, std::size_t r2, std::size_t pos) noexcept;
+};
+
+// kernels of the given level (a level above simd_level() falls back to the best supported one)
+const SearchKernels& search_kernels(SimdLevel level) noexcept;
+// kernels of simd_level(): what BasicMutexString::find()/rfind() use while holding the lock
+const SearchKernels& search_kernels() noexcept;
+
+inline std::size_t fast_find(std::string_view hay, std::string_view needle, std::size_t pos) noexcept {
+    return search_kernels().find(hay, needle, pos);
+}
+inline std::size_t fast_find(std::string_view hay, char ch, std::size_t pos) noexcept {
+    return search_kernels().find_char(hay, ch, pos);
+}
+inline std::size_t fast_rfind(std::string_view hay, std::string_view needle, std::size_t pos) noexcept {
+    return search_kernels().rfind(hay, needle, pos);
+}
+inline std::size_t fast_rfind(std::string_view hay, char ch, std::size_t pos) noexcept {
+    return search_kernels().rfind_char(hay, ch, pos);
+}
+inline std::size_t fast_find_of(std::string_view hay, const CharSet& set, bool member, std::size_t pos) noexcept {
+    return search_kernels().find_of(hay, set, member, pos);
+}
+inline std::size_t fast_rfind_of(std::string_view hay, const CharSet& set, bool member, std::size_t pos) noexcept {
+    return search_kernels().rfind_of(hay, set, member, pos);
+}
+
+} // namespace detail
+
+} // namespace j2